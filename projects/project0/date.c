@@ -9,51 +9,247 @@
  * This is my own work.
  */
 
-#include <stdio.h>      /* Used for sscanf() */
 #include <stdlib.h>     /* Used for malloc(), free(), NULL */
+#include <string.h>     /* Used for strcmp() */
 #include "date.h"       /* Date ADT */
 
 
 /*
- * Struct that represents the Date ADT itself.
+ * Struct that represents the Date ADT itself. The day, month and year are
+ * packed into one integer, (year << 9) | (month << 5) | day, so that two
+ * dates compare in a single integer comparison.
  */
 struct date {
     
-    unsigned short day, month, year;
+    unsigned int packed;
 };
 
+/* Packs the date fields into the comparable representation */
+#define PACK(d, m, y) (((y) << 9) | ((m) << 5) | (d))
+
+/* Decodes the fixed-width numeric fields of a datestamp */
+#define DIGIT(s, i) ((unsigned int)((s)[i] - '0'))
+#define NUM2(s, i) (DIGIT(s, i) * 10 + DIGIT(s, (i) + 1))
+#define NUM4(s, i) (NUM2(s, i) * 100 + NUM2(s, (i) + 2))
+#define MONTH_NUM(s, i) NUM2(s, i)
+#define MONTH_NAME(s, i) month_name((s) + (i))
+
+
+/*
+ * Returns the month number (1-12) named by the 3 letters at `s' (ex. "Oct"),
+ * 0 if the letters do not name a month.
+ */
+static unsigned int month_name(char *s) {
+
+    static const char names[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    unsigned int i;
+
+    for (i = 0; i < 12; i++)
+        if (names[3 * i] == s[0] && names[3 * i + 1] == s[1] && names[3 * i + 2] == s[2])
+            return (i + 1);
+
+    return 0;
+}
+
+/*
+ * Returns `s' unchanged; used by formats that end with their last field.
+ */
+static char *no_tail(char *s) {
+
+    return s;
+}
+
+/*
+ * Skips over the optional time of an ISO-8601 stamp (ex. "T13:55:36Z"),
+ * returns a pointer to the first character after it.
+ */
+static char *iso_tail(char *s) {
+
+    if (*s == 'T')
+        while (*s != '\0' && *s != ' ' && *s != '\t' && *s != '\n')
+            s++;
+
+    return s;
+}
+
+/*
+ * DATE_PARSER expands into a parser specialized for one fixed-width format.
+ * `tmpl' spells out the stamp character by character: '9' matches a digit,
+ * 'A' matches a letter, 'S' matches a '+' or '-' sign, and anything else
+ * must match exactly. `dpos', `mpos' and `ypos' are the offsets of the day,
+ * month and year fields, `month' decodes the month field, and `tail' skips
+ * any variable-length suffix. Since the template and offsets are constants,
+ * each expansion compiles into straight-line checks with no format string
+ * to interpret, unlike sscanf().
+ *
+ * Each parser stores the packed date into `*packed' and returns a pointer
+ * to the first character after the stamp, or NULL on a syntax error.
+ */
+#define DATE_PARSER(fn, tmpl, dpos, mpos, ypos, month, tail)                 \
+static char *fn(char *s, unsigned int *packed) {                            \
+                                                                            \
+    static const char t[] = tmpl;                                           \
+    unsigned int i, day, mon, year;                                         \
+                                                                            \
+    /* Match the template; stops at the first mismatch, including '\0' */  \
+    for (i = 0; i < sizeof(t) - 1; i++) {                                   \
+        if (t[i] == '9') {                                                  \
+            if (s[i] < '0' || s[i] > '9')                                   \
+                return NULL;                                                \
+        } else if (t[i] == 'A') {                                           \
+            if ((s[i] < 'A' || s[i] > 'Z') && (s[i] < 'a' || s[i] > 'z'))   \
+                return NULL;                                                \
+        } else if (t[i] == 'S') {                                           \
+            if (s[i] != '+' && s[i] != '-')                                 \
+                return NULL;                                                \
+        } else if (s[i] != t[i]) {                                          \
+            return NULL;                                                    \
+        }                                                                   \
+    }                                                                       \
+                                                                            \
+    /* Make sure the date information given is valid */                     \
+    day = NUM2(s, dpos);                                                    \
+    mon = month(s, mpos);                                                   \
+    year = NUM4(s, ypos);                                                   \
+    if (day < 1 || day > 31 || mon < 1 || mon > 12 || year < 1)             \
+        return NULL;                                                        \
+                                                                            \
+    *packed = PACK(day, mon, year);                                         \
+    return tail(s + sizeof(t) - 1);                                         \
+}
+
+/* "dd/mm/yyyy" */
+DATE_PARSER(parse_dmy_fixed, "99/99/9999", 0, 3, 6, MONTH_NUM, no_tail)
+/* "yyyy-mm-dd", optionally followed by "Thh:mm:ss..." */
+DATE_PARSER(parse_iso, "9999-99-99", 8, 5, 0, MONTH_NUM, iso_tail)
+/* "[dd/Mon/yyyy:hh:mm:ss +zzzz]" */
+DATE_PARSER(parse_apache, "[99/AAA/9999:99:99:99 S9999]", 1, 4, 8, MONTH_NAME, no_tail)
+
+/*
+ * Reads a number of 1 to `max' digits at `*s', leaving `*s' just after it.
+ * Returns the number, or -1 if `*s' does not start with a digit.
+ */
+static int number(char **s, int max) {
+
+    int n = 0, i;
+
+    for (i = 0; i < max && (*s)[i] >= '0' && (*s)[i] <= '9'; i++)
+        n = n * 10 + ((*s)[i] - '0');
+    *s += i;
+
+    return (i > 0) ? n : -1;
+}
+
+/*
+ * "d/m/yyyy", where the day and month may have 1 or 2 digits and the year 1
+ * to 4, as sscanf("%hu/%hu/%hu") accepted before the fixed-width parsers. The
+ * fixed-width parser is tried first, since zero-padded stamps are the norm.
+ */
+static char *parse_dmy(char *s, unsigned int *packed) {
+
+    char *p;
+    int day, mon, year;
+
+    if ((p = parse_dmy_fixed(s, packed)) != NULL)
+        return p;
+
+    p = s;
+    if ((day = number(&p, 2)) == -1 || *p++ != '/' ||
+            (mon = number(&p, 2)) == -1 || *p++ != '/' ||
+            (year = number(&p, 4)) == -1)
+        return NULL;
+    if (day < 1 || day > 31 || mon < 1 || mon > 12 || year < 1)
+        return NULL;
+
+    *packed = PACK((unsigned int)day, (unsigned int)mon, (unsigned int)year);
+    return p;
+}
+
+/*
+ * Table of the known formats, searched by date_setformat().
+ */
+static struct {
+    char *name;
+    char *(*parse)(char *s, unsigned int *packed);
+} formats[] = {
+    { "dmy", parse_dmy },
+    { "iso", parse_iso },
+    { "apache", parse_apache }
+};
+
+/* The parser used by date_parse(), selected once at startup */
+static char *(*parser)(char *s, unsigned int *packed) = parse_dmy;
+
+
+/*
+ * Local method that allocates a Date holding the packed date.
+ */
+static Date *date_alloc(unsigned int packed) {
+
+    Date *date;
+
+    if ((date = (Date *)malloc(sizeof(Date))) != NULL)
+        date->packed = packed;
+
+    return date;
+}
 
 /*
  * date_create creates a Date structure from `datestr`
- * `datestr' is expected to be of the form "dd/mm/yyyy"
+ * `datestr' is expected to be of the form "dd/mm/yyyy"; the day
+ * and month may also be given as single digits (ex. "1/9/2020")
  * returns pointer to Date structure if successful,
  *         NULL if not (syntax error)
  */
 Date *date_create(char *datestr) {
 
-    Date *date;
-    unsigned short day, month, year;
+    unsigned int packed;
 
     /* Extract the date information from datestr */
-    if (sscanf(datestr, "%hu/%hu/%hu", &day, &month, &year) != 3)
+    if (parse_dmy(datestr, &packed) == NULL)
         return NULL;
 
-    /* Make sure the date information given is valid */
-    if (day < 1 || day > 31)
-        return NULL;
-    if (month < 1 || month > 12)
-        return NULL;
-    if (year < 1 || year > 9999)
-        return NULL;
+    return date_alloc(packed);
+}
+
+/*
+ * date_setformat selects the datestamp format expected by date_parse;
+ * `name' is one of "dmy" (dd/mm/yyyy, the default), "iso"
+ * (yyyy-mm-dd, optionally followed by a time such as Thh:mm:ssZ) or
+ * "apache" ([dd/Mon/yyyy:hh:mm:ss +zzzz])
+ * returns 1 if successful, 0 if `name' is not a known format
+ */
+int date_setformat(char *name) {
+
+    unsigned int i;
 
-    /* Create the date instance, store the extracted date information */
-    if ((date = (Date *)malloc(sizeof(Date))) != NULL) {
-        date->day = day;
-        date->month = month;
-        date->year = year;
+    for (i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+        if (strcmp(formats[i].name, name) == 0) {
+            parser = formats[i].parse;
+            return 1;
+        }
     }
 
-    return date;
+    return 0;
+}
+
+/*
+ * date_parse creates a Date structure from the datestamp at the front of
+ * `line', which is expected to be in the format chosen by date_setformat;
+ * on success, `*end' is set to the first character after the datestamp
+ * returns pointer to Date structure if successful,
+ *         NULL if not (syntax error or memory allocation failure)
+ */
+Date *date_parse(char *line, char **end) {
+
+    unsigned int packed;
+    char *p;
+
+    if ((p = (*parser)(line, &packed)) == NULL)
+        return NULL;
+    *end = p;
+
+    return date_alloc(packed);
 }
 
 /*
@@ -82,16 +278,8 @@ Date *date_duplicate(Date *d) {
  */
 int date_compare(Date *date1, Date *date2) {
 
-    /* Years are unequal, return the comparison */
-    if (date1->year != date2->year)
-        return (date1->year - date2->year);
-
-    /* Months are unequal, return the comparison */
-    if (date1->month != date2->month)
-        return (date1->month - date2->month);
-
-    /* Return comparison between the days */
-    return (date1->day - date2->day);
+    /* Packed dates order the same way as the dates themselves */
+    return ((int)date1->packed - (int)date2->packed);
 }
 
 /*
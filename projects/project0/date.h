@@ -11,6 +11,24 @@ typedef struct date Date;
  */
 Date *date_create(char *datestr);
 
+/*
+ * date_setformat selects the datestamp format expected by date_parse;
+ * `name' is one of "dmy" (dd/mm/yyyy, the default), "iso"
+ * (yyyy-mm-dd, optionally followed by a time such as Thh:mm:ssZ) or
+ * "apache" ([dd/Mon/yyyy:hh:mm:ss +zzzz])
+ * returns 1 if successful, 0 if `name' is not a known format
+ */
+int date_setformat(char *name);
+
+/*
+ * date_parse creates a Date structure from the datestamp at the front of
+ * `line', which is expected to be in the format chosen by date_setformat;
+ * on success, `*end' is set to the first character after the datestamp
+ * returns pointer to Date structure if successful,
+ *         NULL if not (syntax error or memory allocation failure)
+ */
+Date *date_parse(char *line, char **end);
+
 /*
  * date_duplicate creates a duplicate of `d'
  * returns pointer to new Date structure if successful,
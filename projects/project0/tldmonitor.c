@@ -3,16 +3,42 @@
 #include <stdio.h>
 #include <string.h>
 
-#define USAGE "usage: %s begin_datestamp end_datestamp [file] ...\n"
+#define USAGE "usage: %s [--date-format=dmy|iso|apache] begin_datestamp end_datestamp [file] ...\n" \
+              "       both datestamps are given in the --date-format (default dmy)\n"
 
-static void process(FILE *fd, TLDList *tld) {
+/*
+ * parses a begin or end datestamp given on the command line, in the
+ * format selected by --date-format; the whole argument must be the stamp
+ */
+static Date *parse_arg(char *arg) {
+    char *p;
+    Date *d = date_parse(arg, &p);
+    if (d != NULL && *p != '\0') {
+        date_destroy(d);
+        d = NULL;
+    }
+    return d;
+}
+
+/*
+ * adds the entries read from `fd' to `tld'
+ * returns the number of lines skipped for a bad datestamp
+ */
+static long process(FILE *fd, TLDList *tld) {
     char bf[1024], sbf[1024];
     Date *d;
+    long skipped = 0L;
     while (fgets(bf, sizeof(bf), fd) != NULL) {
-        char *q, *p = strchr(bf, ' ');
-	if (p == NULL) {
+        char *q, *p;
+	d = date_parse(bf, &p);
+	if (d == NULL) {
+	    skipped++;	/* bad datestamp, entry is not counted */
+	    continue;
+	}
+	if (*p != ' ') {
             fprintf(stderr, "Illegal input line: %s", bf);
-	    return;
+	    date_destroy(d);
+	    return skipped;
         }
 	strcpy(sbf, bf);
 	*p++ = '\0';
@@ -21,40 +47,49 @@ static void process(FILE *fd, TLDList *tld) {
 	q = strchr(p, '\n');
 	if (q == NULL) {
             fprintf(stderr, "Illegal input line: %s", sbf);
-	    return;
+	    date_destroy(d);
+	    return skipped;
         }
 	*q = '\0';
-	d = date_create(bf);
 	(void) tldlist_add(tld, p, d);
 	date_destroy(d);
     }
+    return skipped;
 }
 
 int main(int argc, char *argv[]) {
     Date *begin = NULL, *end = NULL;
-    int i;
+    int i, first = 1;
     FILE *fd;
     TLDList *tld = NULL;
     TLDIterator *it = NULL;
     TLDNode *n;
     double total;
+    long skipped = 0L;
 
-    if (argc < 3) {
+    if (argc > 1 && strncmp(argv[1], "--date-format=", 14) == 0) {
+        if (! date_setformat(argv[1] + 14)) {
+            fprintf(stderr, "Unknown date format: %s\n", argv[1] + 14);
+            return -1;
+        }
+        first = 2;
+    }
+    if (argc < first + 2) {
         fprintf(stderr, USAGE, argv[0]);
         return -1;
     }
-    begin = date_create(argv[1]);
+    begin = parse_arg(argv[first]);
     if (begin == NULL) {
-        fprintf(stderr, "Error processing begin date: %s\n", argv[1]);
+        fprintf(stderr, "Error processing begin date: %s\n", argv[first]);
         goto error;
     }
-    end = date_create(argv[2]);
+    end = parse_arg(argv[first + 1]);
     if (end == NULL) {
-        fprintf(stderr, "Error processing end date: %s\n", argv[2]);
+        fprintf(stderr, "Error processing end date: %s\n", argv[first + 1]);
         goto error;
     }
     if (date_compare(begin, end) > 0) {
-        fprintf(stderr, "%s > %s\n", argv[1], argv[2]);
+        fprintf(stderr, "%s > %s\n", argv[first], argv[first + 1]);
 	goto error;
     }
     tld = tldlist_create(begin, end);
@@ -62,10 +97,10 @@ int main(int argc, char *argv[]) {
         fprintf(stderr, "Unable to create TLD list\n");
         goto error;
     }
-    if (argc == 3)
-        process(stdin, tld);
+    if (argc == first + 2)
+        skipped += process(stdin, tld);
     else {
-        for (i = 3; i < argc; i++) {
+        for (i = first + 2; i < argc; i++) {
             if (strcmp(argv[i], "-") == 0)
                 fd = stdin;
             else
@@ -74,11 +109,13 @@ int main(int argc, char *argv[]) {
                 fprintf(stderr, "Unable to open %s\n", argv[i]);
                 continue;
             }
-            process(fd, tld);
+            skipped += process(fd, tld);
             if (fd != stdin)
                 fclose(fd);
         }
     }
+    if (skipped > 0L)
+        fprintf(stderr, "Skipped %ld line(s) with a bad datestamp\n", skipped);
     total = (double)tldlist_count(tld);
     it = tldlist_iter_create(tld);
     if (it == NULL) {
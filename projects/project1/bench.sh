@@ -0,0 +1,158 @@
+#!/bin/bash
+#
+# bench.sh
+# Author: Cole Vikupitz
+# CIS 415 - Project 1
+#
+# Benchmarks each version of USPS, and each policy of v5, on a generated mixed
+# workload of cpubound and iobound jobs. The CPU-bound jobs run for a staggered
+# amount of CPU time, from short to long; the I/O-bound jobs sleep in 1 ms naps
+# between bursts of writes, for a staggered number of naps, from long to short.
+#
+# Each job logs its own start, end, and CPU time (see -log in cpubound.c), and
+# one CSV row is written per run with:
+#
+#   makespan        wall time of the whole run
+#   turnaround      from the run starting until the job finishes (mean, p99)
+#   response        from the run starting until the job first runs (mean, p99)
+#   sched_cpu       CPU time used by USPS itself; the CPU time of the run minus
+#                   the CPU time the jobs report for themselves
+#
+# All times are in ms. Run with -h for the options.
+#
+# This is my own work.
+#
+
+DIR=$(cd "$(dirname "$0")" && pwd)
+
+# Defaults, see usage()
+NCPU=4
+NIO=4
+SHORT=50
+LONG=400
+QUANTUM=100
+RUNS=1
+VERSIONS="1 2 3 4 5"
+POLICIES="adaptive rr mlfq cfs edf sjf"
+OUT=bench.csv
+
+usage() {
+    echo "Usage: $0 [-c <n>] [-i <n>] [-s <ms>] [-l <ms>] [-q <ms>] [-r <n>] [-v <versions>] [-p <policies>] [-o <file>]"
+    echo "  -c <n>        : Number of CPU-bound jobs (default $NCPU)."
+    echo "  -i <n>        : Number of I/O-bound jobs (default $NIO)."
+    echo "  -s <ms>       : Size of the shortest job (default $SHORT)."
+    echo "  -l <ms>       : Size of the longest job (default $LONG)."
+    echo "  -q <ms>       : Quantum given to USPS (default $QUANTUM)."
+    echo "  -r <n>        : Runs of each version and policy (default $RUNS)."
+    echo "  -v <versions> : USPS versions to run (default \"$VERSIONS\")."
+    echo "  -p <policies> : v5 policies to run (default \"$POLICIES\")."
+    echo "  -o <file>     : CSV file to write (default $OUT)."
+    exit 1
+}
+
+while getopts "c:i:s:l:q:r:v:p:o:h" opt; do
+    case $opt in
+        c) NCPU=$OPTARG ;;
+        i) NIO=$OPTARG ;;
+        s) SHORT=$OPTARG ;;
+        l) LONG=$OPTARG ;;
+        q) QUANTUM=$OPTARG ;;
+        r) RUNS=$OPTARG ;;
+        v) VERSIONS=$OPTARG ;;
+        p) POLICIES=$OPTARG ;;
+        o) OUT=$OPTARG ;;
+        *) usage ;;
+    esac
+done
+
+for prog in cpubound iobound; do
+    if [ ! -x "$DIR/$prog" ]; then
+        echo "ERROR: $DIR/$prog not found, build it with 'make test'."
+        exit 1
+    fi
+done
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+WORKLOAD=$WORK/workload
+LOG=$WORK/log
+
+# Size of the i-th of n jobs, staggered evenly from SHORT to LONG
+size() {
+    if [ "$2" -le 1 ]; then
+        echo "$SHORT"
+    else
+        echo $((SHORT + (LONG - SHORT) * $1 / ($2 - 1)))
+    fi
+}
+
+# Generate the workload, alternating between the two kinds of jobs
+: > "$WORKLOAD"
+i=0
+while [ $i -lt "$NCPU" ] || [ $i -lt "$NIO" ]; do
+    if [ $i -lt "$NCPU" ]; then
+        echo "$DIR/cpubound -ms $(size $i "$NCPU") -name c$i -log $LOG" >> "$WORKLOAD"
+    fi
+    if [ $i -lt "$NIO" ]; then
+        echo "$DIR/iobound -ms $(size $((NIO - 1 - i)) "$NIO") -name i$i -log $LOG" >> "$WORKLOAD"
+    fi
+    i=$((i + 1))
+done
+JOBS=$(wc -l < "$WORKLOAD")
+
+# Runs one benchmark and appends its row; $1 is the version, $2 the policy
+bench() {
+    local prog=$DIR/uspsv$1 args="--quantum=$QUANTUM" t0 t1 cpu run
+
+    if [ ! -x "$prog" ]; then
+        echo "ERROR: $prog not found, build it with 'make'."
+        exit 1
+    fi
+    [ "$2" != "-" ] && args="$args --policy=$2"
+
+    for run in $(seq 1 "$RUNS"); do
+        : > "$LOG"
+        TIMEFORMAT='%3U %3S'
+        t0=$(date +%s%N)
+        cpu=$( { time "$prog" $args "$WORKLOAD" > /dev/null 2>&1; } 2>&1 )
+        t1=$(date +%s%N)
+        awk -v v="$1" -v p="$2" -v run="$run" -v jobs="$JOBS" -v t0="$t0" -v t1="$t1" \
+                -v cpu="$cpu" -v ncpu="$NCPU" -v nio="$NIO" '
+            # Returns the p-th percentile of a[1..n], sorting it first
+            function pct(a, n, p,    i, j, x, k) {
+                for (i = 2; i <= n; i++) {
+                    x = a[i]
+                    for (j = i - 1; j >= 1 && a[j] > x; j--)
+                        a[j + 1] = a[j]
+                    a[j + 1] = x
+                }
+                k = int((n * p + 99) / 100)
+                return (k < 1) ? 0 : a[k]
+            }
+            {
+                n++
+                ta[n] = ($3 - t0) / 1e6; tsum += ta[n]
+                rs[n] = ($2 - t0) / 1e6; rsum += rs[n]
+                jobcpu += $4 / 1e6
+            }
+            END {
+                split(cpu, c, " ")
+                printf "%s,%s,%d,%d,%d,%d,%d,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n", v, p, run, ncpu, nio, jobs, n,
+                    (t1 - t0) / 1e6, n ? tsum / n : 0, pct(ta, n, 99), n ? rsum / n : 0, pct(rs, n, 99),
+                    (c[1] + c[2]) * 1000 - jobcpu
+            }' "$LOG" >> "$OUT"
+        tail -n 1 "$OUT"
+    done
+}
+
+echo "version,policy,run,cpu_jobs,io_jobs,jobs,finished,makespan_ms,mean_turnaround_ms,p99_turnaround_ms," \
+    "mean_response_ms,p99_response_ms,sched_cpu_ms" | tr -d ' ' > "$OUT"
+for v in $VERSIONS; do
+    if [ "$v" = 5 ]; then
+        for p in $POLICIES; do
+            bench 5 "$p"
+        done
+    else
+        bench "$v" -
+    fi
+done
@@ -0,0 +1,85 @@
+/*
+ * check_cfs.c
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Checks the accounting of the fair-share policy without running any jobs: that
+ * the virtual runtime of a process is charged from the CPU time it used, divided
+ * by its weight. The CPU times are fed to the queue by hand, the way USPS v5
+ * polls them before each call, so a process that slept through its slice is one
+ * whose CPU time did not advance, and it must not be charged for that slice.
+ *
+ * Prints one line per check; exits with 1 if any failed, 0 if not.
+ *
+ * This is my own work.
+ */
+
+#include <stdio.h>      /* Used for printf() */
+#include <stdlib.h>     /* Used for NULL */
+#include "process.h"    /* Process ADT */
+#include "sched.h"      /* Scheduling policy interface */
+
+/* Quantum and slice (in us) the queue is set up with */
+#define QUANTUM 100000
+#define SLICE 20000
+
+static int failed = 0;
+
+
+/*
+ * Reports the check, counts it if it failed.
+ */
+static void check(char *what, unsigned long long got, unsigned long long want) {
+
+    printf("%s: %s (vruntime %llu ns, expected %llu ns)\n",
+        (got == want) ? "PASS" : "FAIL", what, got, want);
+    if (got != want)
+        failed++;
+}
+
+int main(void) {
+
+    SchedConf conf;
+    Process *pr, *heavy;
+    void *q;
+
+    conf.quantum = QUANTUM;
+    conf.slice = SLICE;
+    conf.epoch = sched_now();
+    if ((q = (*cfs_policy.create)(&conf)) == NULL ||
+            (pr = malloc_pr("./iobound")) == NULL ||
+            (heavy = malloc_pr("@weight=2 ./cpubound")) == NULL) {
+        printf("FAIL: allocation\n");
+        return 1;
+    }
+    (*cfs_policy.admit)(q, pr);
+    (*cfs_policy.admit)(q, heavy);
+
+    /* Dispatched with no CPU used yet, then runs for 3 ms of its quantum */
+    pr_poll_cpu(pr, sched_now(), 0ULL);
+    pr_poll_cpu(pr, sched_now(), 3000000ULL);
+    (*cfs_policy.on_tick)(q, pr);
+    check("charged for the CPU time it used", pr_vruntime(pr), 3000000ULL);
+
+    /* Sleeps through the rest of its slice, using no more CPU, then blocks */
+    pr_poll_cpu(pr, sched_now(), 3000000ULL);
+    (*cfs_policy.on_block)(q, pr);
+    check("not charged for sleeping", pr_vruntime(pr), 3000000ULL);
+
+    /* Runs again after waking up, for 1 ms more */
+    pr_poll_cpu(pr, sched_now(), 4000000ULL);
+    (*cfs_policy.on_tick)(q, pr);
+    check("charged only for the CPU time since", pr_vruntime(pr), 4000000ULL);
+
+    /* A process of weight 2 is charged half */
+    pr_poll_cpu(heavy, sched_now(), 0ULL);
+    pr_poll_cpu(heavy, sched_now(), 8000000ULL);
+    (*cfs_policy.on_tick)(q, heavy);
+    check("charged by weight", pr_vruntime(heavy), 4000000ULL);
+
+    (*cfs_policy.destroy)(q, NULL);
+    free_pr(pr);
+    free_pr(heavy);
+
+    return (failed > 0) ? 1 : 0;
+}
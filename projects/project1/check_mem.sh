@@ -0,0 +1,57 @@
+#!/bin/bash
+#
+# check_mem.sh
+# Author: Cole Vikupitz
+# CIS 415 - Project 1
+#
+# Checks that USPS v5 keeps the resident memory of its jobs within --mem-limit=.
+# Runs more jobs than fit in LIMIT_MB at once, on enough lanes to start them all
+# together, and reads the memory line USPS prints at the end. Each job is the
+# cpubound binary as built, told to allocate and touch JOB_MB MB by its -mb flag;
+# nothing is edited or rebuilt, only a workload file in a temporary directory is
+# written. The memory line reads:
+#
+#   Memory: peak <X> MB resident of <L> MB, <N> starts deferred
+#
+# Passes if some starts were deferred (N > 0), and the peak stayed within the
+# limit (X <= L). Exits with 1 if not, 0 if so.
+#
+# This is my own work.
+#
+
+DIR=$(cd "$(dirname "$0")" && pwd)
+
+JOBS=4
+JOB_MB=60
+LIMIT_MB=150
+
+for prog in uspsv5 cpubound; do
+    if [ ! -x "$DIR/$prog" ]; then
+        echo "ERROR: $DIR/$prog not found, build it with 'make all test'."
+        exit 1
+    fi
+done
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+WORKLOAD=$WORK/workload
+
+for ((i = 0; i < JOBS; i++)); do
+    echo "$DIR/cpubound -mb $JOB_MB -ms 300" >> "$WORKLOAD"
+done
+
+LINE=$("$DIR/uspsv5" --quantum=100 --cpus=$JOBS --quiet --mem-limit=$LIMIT_MB "$WORKLOAD" 2>&1 |
+    grep '^Memory:')
+read -r PEAK LIMIT DEFERRED <<< "$(echo "$LINE" |
+    sed -n 's/^Memory: peak \([0-9]*\) MB resident of \([0-9]*\) MB, \([0-9]*\) starts deferred$/\1 \2 \3/p')"
+
+if [ -z "$PEAK" ]; then
+    echo "FAIL: no memory line in the output of uspsv5"
+    exit 1
+fi
+if [ "$DEFERRED" -gt 0 ] && [ "$PEAK" -le "$LIMIT" ]; then
+    echo "PASS: $JOBS jobs of $JOB_MB MB peaked at $PEAK MB of $LIMIT MB, $DEFERRED starts deferred"
+    exit 0
+fi
+echo "FAIL: $JOBS jobs of $JOB_MB MB peaked at $PEAK MB of $LIMIT MB, $DEFERRED starts deferred"
+exit 1
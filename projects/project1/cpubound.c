@@ -1,12 +1,40 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
+#include <sys/resource.h>
+
+/*
+ * appends "name start_ns end_ns cpu_ns" to the log file, with the wall clock
+ * times this program started and finished, and the CPU time it used
+ */
+static void log_times(char *log, char *name, struct timespec *start) {
+    struct timespec end;
+    struct rusage ru;
+    FILE *fp;
+
+    if (log == NULL || (fp = fopen(log, "a")) == NULL)
+        return;
+    clock_gettime(CLOCK_REALTIME, &end);
+    getrusage(RUSAGE_SELF, &ru);
+    fprintf(fp, "%s %lld %lld %lld\n", name,
+        start->tv_sec * 1000000000LL + start->tv_nsec,
+        end.tv_sec * 1000000000LL + end.tv_nsec,
+        (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000000LL +
+        (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1000LL);
+    fclose(fp);
+}
 
 int main(int argc, char **argv) {
     long long i;
-    int minutes = 1, j;
-    char name[128];
+    int minutes = 1, j, ms = 0, mb = 0;
+    volatile char *mem = NULL;
+    char name[128] = "cpubound";
+    char *log = NULL;
+    struct timespec start;
+    clock_t target;
 
+    clock_gettime(CLOCK_REALTIME, &start);
 /*
  * process environment variable and command line arguments
  */
@@ -14,18 +42,55 @@ int main(int argc, char **argv) {
         if (strcmp(argv[i], "-minutes") == 0) {
             i++;
             minutes = atoi(argv[i]);
+        } else if (strcmp(argv[i], "-ms") == 0) {
+            i++;
+            ms = atoi(argv[i]);
+        } else if (strcmp(argv[i], "-mb") == 0) {
+            i++;
+            mb = atoi(argv[i]);
         } else if (strcmp(argv[i], "-name") == 0) {
             i++;
             strcpy(name, argv[i]);
+        } else if (strcmp(argv[i], "-log") == 0) {
+            i++;
+            log = argv[i];
         } else {
             fprintf(stderr, "Illegal flag: `%s'\n", argv[i]);
             exit(1);
         }
     }
-    for (j = 0; j < minutes; j++) {
-        for (i = 0; i < 30000000000; i++) {
-            ;
+/*
+ * -mb allocates that many megabytes first, and writes to every page of them,
+ * so that they are resident while it runs
+ */
+    if (mb > 0) {
+        if ((mem = (volatile char *)malloc((size_t)mb << 20)) == NULL) {
+            fprintf(stderr, "Failed to allocate %d MB\n", mb);
+            exit(1);
+        }
+        for (i = 0; i < ((long long)mb << 20); i += 4096) {
+            mem[i] = 1;
+        }
+    }
+/*
+ * -ms runs until that much CPU time is used, so that time spent stopped by
+ * the scheduler does not count
+ */
+    if (ms > 0) {
+        target = (clock_t)((long long)ms * CLOCKS_PER_SEC / 1000);
+        while (clock() < target) {
+            for (i = 0; i < 1000000; i++) {
+                ;
+            }
+        }
+    } else {
+        for (j = 0; j < minutes; j++) {
+            for (i = 0; i < 30000000000; i++) {
+                ;
+            }
         }
     }
+    free((void *)mem);
+    log_times(log, name, &start);
     return 0;
 }
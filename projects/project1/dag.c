@@ -0,0 +1,197 @@
+/*
+ * dag.c
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Source file for the Dag ADT implementation. Only the outcome of each named job
+ * is kept, in a hash table with separate chaining; the edges are the '@after='
+ * lists of the jobs still waiting, which are checked again as jobs finish. Names
+ * are looked up in place within those lists, without copying them.
+ *
+ * This is my own work.
+ */
+
+#include <stdlib.h>     /* Used for malloc(), calloc(), free(), NULL */
+#include "dag.h"        /* Dag ADT */
+#include "p1fxns.h"     /* Used for p1strdup(), p1strlen(), p1strneq() */
+
+/* Number of buckets allocated at first */
+#define MIN_BUCKETS 64L
+
+/* Outcomes of a job */
+#define PENDING 0       /* Not finished yet */
+#define SUCCEEDED 1     /* Exited with status 0 */
+#define FAILED 2        /* Failed, or never ran */
+
+
+/*
+ * A named job, chained into its bucket
+ */
+typedef struct node {
+    struct node *next;          /* Next node in the bucket */
+    char *name;                 /* The job's name */
+    int len;                    /* Length of the name */
+    int state;                  /* PENDING, SUCCEEDED, or FAILED */
+} Node;
+
+/*
+ * Struct that represents the DAG itself
+ */
+struct dag {
+    Node **buckets;             /* Array of buckets, length is a power of 2 */
+    long mask;                  /* Number of buckets minus one */
+    long size;                  /* Number of jobs named */
+};
+
+
+/*
+ * Local method that returns the bucket of the name of length 'len' (FNV-1a).
+ */
+static long bucket(Dag *dg, char *name, int len) {
+
+    unsigned long h = 2166136261UL;
+    int i;
+
+    for (i = 0; i < len; i++)
+        h = (h ^ (unsigned char)name[i]) * 16777619UL;
+
+    return (long)(h & (unsigned long)dg->mask);
+}
+
+/*
+ * Local method that returns the node of the name of length 'len', or NULL.
+ */
+static Node *lookup(Dag *dg, char *name, int len) {
+
+    Node *nd;
+
+    for (nd = dg->buckets[bucket(dg, name, len)]; nd != NULL; nd = nd->next)
+        if (nd->len == len && p1strneq(nd->name, name, len))
+            return nd;
+
+    return NULL;
+}
+
+/*
+ * Local method that doubles the number of buckets, moving every node over.
+ * Returns 1 if successful, 0 if allocation failed.
+ */
+static int grow(Dag *dg) {
+
+    Node **old = dg->buckets, *nd, *next;
+    long i, oldlen = dg->mask + 1;
+
+    if ((dg->buckets = (Node **)calloc(2 * oldlen, sizeof(Node *))) == NULL) {
+        dg->buckets = old;
+        return 0;
+    }
+    dg->mask = 2 * oldlen - 1;
+
+    for (i = 0; i < oldlen; i++) {
+        for (nd = old[i]; nd != NULL; nd = next) {
+            next = nd->next;
+            nd->next = dg->buckets[bucket(dg, nd->name, nd->len)];
+            dg->buckets[bucket(dg, nd->name, nd->len)] = nd;
+        }
+    }
+    free(old);
+
+    return 1;
+}
+
+Dag *dg_create(void) {
+
+    /* Allocate memory, initialize the members */
+    Dag *dg = (Dag *)malloc(sizeof(Dag));
+    if (dg != NULL) {
+        if ((dg->buckets = (Node **)calloc(MIN_BUCKETS, sizeof(Node *))) != NULL) {
+            dg->mask = MIN_BUCKETS - 1;
+            dg->size = 0L;
+        } else {
+            /* Allocation failed, free the struct */
+            free(dg);
+            dg = NULL;
+        }
+    }
+
+    return dg;
+}
+
+int dg_add(Dag *dg, char *name) {
+
+    Node *nd;
+    long b;
+    int len = p1strlen(name);
+
+    if (lookup(dg, name, len) != NULL)
+        return -1;
+
+    /* Keep chains short, at no more than two nodes per bucket on average */
+    if (dg->size >= 2 * (dg->mask + 1) && !grow(dg))
+        return 0;
+
+    if ((nd = (Node *)malloc(sizeof(Node))) == NULL)
+        return 0;
+    if ((nd->name = p1strdup(name)) == NULL) {
+        free(nd);
+        return 0;
+    }
+    nd->len = len;
+    nd->state = PENDING;
+    b = bucket(dg, name, len);
+    nd->next = dg->buckets[b];
+    dg->buckets[b] = nd;
+    dg->size++;
+
+    return 1;
+}
+
+void dg_finish(Dag *dg, char *name, int ok) {
+
+    Node *nd = lookup(dg, name, p1strlen(name));
+
+    if (nd != NULL)
+        nd->state = ok ? SUCCEEDED : FAILED;
+}
+
+DagStatus dg_check(Dag *dg, char *after) {
+
+    DagStatus status = DG_READY;
+    Node *nd;
+    int len;
+
+    while (*after != '\0') {
+        /* Find the end of the next name */
+        for (len = 0; after[len] != '\0' && after[len] != ','; len++)
+            ;
+        if (len > 0) {
+            if ((nd = lookup(dg, after, len)) == NULL)
+                return DG_UNKNOWN;
+            if (nd->state == FAILED)
+                return DG_FAILED;
+            if (nd->state == PENDING)
+                status = DG_WAITING;
+        }
+        after += (after[len] == ',') ? len + 1 : len;
+    }
+
+    return status;
+}
+
+void dg_destroy(Dag *dg) {
+
+    Node *nd, *next;
+    long i;
+
+    if (dg != NULL) {
+        for (i = 0; i <= dg->mask; i++) {
+            for (nd = dg->buckets[i]; nd != NULL; nd = next) {
+                next = nd->next;
+                free(nd->name);
+                free(nd);
+            }
+        }
+        free(dg->buckets);
+        free(dg);
+    }
+}
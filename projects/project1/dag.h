@@ -0,0 +1,66 @@
+/*
+ * dag.h
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Header file for the Dag ADT implementation, which keeps the outcome of every
+ * named job in a workload, so that jobs declared to run after others ('@after=')
+ * can be released once those have succeeded, or failed once one of them has.
+ * A job may only run after jobs named before it, so the graph never has a cycle.
+ *
+ * This is my own work.
+ */
+
+#ifndef _DAG_H__
+#define _DAG_H__
+
+
+/*
+ * Data structure mapping job names to their outcome.
+ */
+typedef struct dag Dag;
+
+/*
+ * Whether a job may run, given the jobs it runs after.
+ */
+typedef enum {
+    DG_READY,                   /* Every job it runs after succeeded */
+    DG_WAITING,                 /* Some have not finished yet, none failed */
+    DG_FAILED,                  /* One of them failed */
+    DG_UNKNOWN                  /* One of them was never named */
+} DagStatus;
+
+
+/*
+ * Creates a new, empty instance of the DAG. Returns pointer to new instance, or
+ * NULL if allocation failed.
+ */
+Dag *dg_create(void);
+
+/*
+ * Names a new job, which has not finished yet.
+ *
+ * Returns 1 if successful, 0 if allocation failed, -1 if the name is taken.
+ */
+int dg_add(Dag *dg, char *name);
+
+/*
+ * Records that the named job finished; 'ok' is 1 if it succeeded, 0 if it
+ * failed or never ran. Does nothing if the name is unknown.
+ */
+void dg_finish(Dag *dg, char *name, int ok);
+
+/*
+ * Returns whether a job may run, given 'after', the comma separated names of
+ * the jobs it runs after. A job that fails is reported ahead of one that has
+ * not finished.
+ */
+DagStatus dg_check(Dag *dg, char *after);
+
+/*
+ * Destroys the DAG instance.
+ */
+void dg_destroy(Dag *dg);
+
+
+#endif/* _DAG_H__ */
@@ -0,0 +1,128 @@
+/*
+ * heap.c
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Source file for the Heap ADT implementation. Contains an implementation
+ * of a generic binary min-heap, stored in a growable array.
+ *
+ * This is my own work.
+ */
+
+#include <stdlib.h>     /* Used for malloc(), realloc(), free() */
+#include "heap.h"       /* Heap ADT */
+
+/* Initial capacity of the array */
+#define DEFAULT_CAPACITY 16L
+
+
+/*
+ * Struct that represents the heap itself
+ */
+struct heap {
+    void **items;               /* Array of items, items[0] is the smallest */
+    long size;                  /* Number of items stored */
+    long capacity;              /* Length of the array */
+    int (*cmp)(void *, void *); /* Comparison function */
+};
+
+
+Heap *hp_create(int (*cmp)(void *, void *)) {
+
+    /* Allocate memory, initialize the members */
+    Heap *hp = (Heap *)malloc(sizeof(Heap));
+    if (hp != NULL) {
+        if ((hp->items = (void **)malloc(sizeof(void *) * DEFAULT_CAPACITY)) != NULL) {
+            hp->size = 0L;
+            hp->capacity = DEFAULT_CAPACITY;
+            hp->cmp = cmp;
+        } else {
+            /* Allocation failed, free the struct */
+            free(hp);
+            hp = NULL;
+        }
+    }
+
+    return hp;
+}
+
+int hp_insert(Heap *hp, void *item) {
+
+    void **temp;
+    long i, parent;
+
+    /* Double the array when full */
+    if (hp->size == hp->capacity) {
+        temp = (void **)realloc(hp->items, sizeof(void *) * hp->capacity * 2);
+        if (temp == NULL)
+            return 0;
+        hp->items = temp;
+        hp->capacity *= 2;
+    }
+
+    /* Sift the new item up from the bottom */
+    for (i = hp->size++; i > 0L; i = parent) {
+        parent = (i - 1) / 2;
+        if ((*hp->cmp)(hp->items[parent], item) <= 0)
+            break;
+        hp->items[i] = hp->items[parent];
+    }
+    hp->items[i] = item;
+
+    return 1;
+}
+
+int hp_peek(Heap *hp, void **min) {
+
+    if (hp->size == 0L)
+        return 0;
+    *min = hp->items[0];
+
+    return 1;
+}
+
+int hp_remove(Heap *hp, void **min) {
+
+    void *last;
+    long i, child;
+
+    if (hp->size == 0L)
+        return 0;
+    *min = hp->items[0];
+
+    /* Sift the last item down from the top */
+    last = hp->items[--hp->size];
+    for (i = 0L; (child = 2 * i + 1) < hp->size; i = child) {
+        if (child + 1 < hp->size && (*hp->cmp)(hp->items[child + 1], hp->items[child]) < 0)
+            child++;
+        if ((*hp->cmp)(last, hp->items[child]) <= 0)
+            break;
+        hp->items[i] = hp->items[child];
+    }
+    hp->items[i] = last;
+
+    return 1;
+}
+
+long hp_size(Heap *hp) {
+
+    return hp->size;
+}
+
+int hp_isEmpty(Heap *hp) {
+
+    return (hp->size == 0L);
+}
+
+void hp_destroy(Heap *hp, void (*destructor)(void *)) {
+
+    long i;
+
+    if (hp != NULL) {
+        /* Invoke destructor on each item if not NULL */
+        for (i = 0L; destructor != NULL && i < hp->size; i++)
+            (*destructor)(hp->items[i]);
+        free(hp->items);
+        free(hp);
+    }
+}
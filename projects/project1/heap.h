@@ -0,0 +1,67 @@
+/*
+ * heap.h
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Header file for the Heap ADT implementation.
+ *
+ * This is my own work.
+ */
+
+#ifndef _HEAP_H__
+#define _HEAP_H__
+
+
+/*
+ * Data structure for a generic binary min-heap. Items are ordered by the
+ * comparison function given at creation.
+ */
+typedef struct heap Heap;
+
+
+/*
+ * Creates a new instance of the heap. 'cmp' returns <0, 0, >0 if its first
+ * item orders before, the same as, or after its second item. Returns pointer
+ * to new instance, or NULL if allocation failed.
+ */
+Heap *hp_create(int (*cmp)(void *, void *));
+
+/*
+ * Inserts 'item' into the heap.
+ *
+ * Returns 1 if insertion successful, 0 if not (allocation failed).
+ */
+int hp_insert(Heap *hp, void *item);
+
+/*
+ * Retrieves the smallest item in the heap, stores result into '*min'.
+ *
+ * Returns 1 if retrieval successful, 0 if not (heap is empty).
+ */
+int hp_peek(Heap *hp, void **min);
+
+/*
+ * Removes the smallest item in the heap, stores result into '*min'.
+ *
+ * Returns 1 if removal was successful, 0 if not (heap is empty).
+ */
+int hp_remove(Heap *hp, void **min);
+
+/*
+ * Returns the heap's current size.
+ */
+long hp_size(Heap *hp);
+
+/*
+ * Returns 1/0 indicating whether the heap is currently empty.
+ */
+int hp_isEmpty(Heap *hp);
+
+/*
+ * Destroys the heap instance. If destructor != NULL, it is invoked on
+ * each item in the heap before destruction.
+ */
+void hp_destroy(Heap *hp, void (*destructor)(void *));
+
+
+#endif/* _HEAP_H__ */
@@ -3,15 +3,41 @@
 #include <stdlib.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/resource.h>
 #include <fcntl.h>
+#include <time.h>
 #include <unistd.h>
 
+/*
+ * appends "name start_ns end_ns cpu_ns" to the log file, with the wall clock
+ * times this program started and finished, and the CPU time it used
+ */
+static void log_times(char *log, char *name, struct timespec *start) {
+    struct timespec end;
+    struct rusage ru;
+    FILE *fp;
+
+    if (log == NULL || (fp = fopen(log, "a")) == NULL)
+        return;
+    clock_gettime(CLOCK_REALTIME, &end);
+    getrusage(RUSAGE_SELF, &ru);
+    fprintf(fp, "%s %lld %lld %lld\n", name,
+        start->tv_sec * 1000000000LL + start->tv_nsec,
+        end.tv_sec * 1000000000LL + end.tv_nsec,
+        (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000000LL +
+        (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1000LL);
+    fclose(fp);
+}
+
 int main(int argc, char **argv) {
-    int i, j, minutes = 1, number = 600000000;
+    int i, j, minutes = 1, number = 600000000, ms = 0;
     char b[1000];
     int fd = open("/dev/null", O_WRONLY);
-    char name[128];
+    char name[128] = "iobound";
+    char *log = NULL;
+    struct timespec start, nap = { 0, 1000000L };
 
+    clock_gettime(CLOCK_REALTIME, &start);
 /*
  * process environment variable and command line arguments
  */
@@ -19,17 +45,36 @@ int main(int argc, char **argv) {
         if (strcmp(argv[i], "-minutes") == 0) {
             i++;
             minutes = atoi(argv[i]);
+        } else if (strcmp(argv[i], "-ms") == 0) {
+            i++;
+            ms = atoi(argv[i]);
         } else if (strcmp(argv[i], "-name") == 0) {
             i++;
             strcpy(name, argv[i]);
+        } else if (strcmp(argv[i], "-log") == 0) {
+            i++;
+            log = argv[i];
         } else {
             fprintf(stderr, "Illegal flag: `%s'\n", argv[i]);
             exit(1);
         }
     }
-    for (i = 0; i < minutes; i++) {
-        for (j = 0; j < number; j++)
-             (void) write(fd, b, sizeof(b));
+/*
+ * -ms waits on 1 ms sleeps that many times, with a short burst of writes
+ * before each, so that it spends most of its time blocked
+ */
+    if (ms > 0) {
+        for (i = 0; i < ms; i++) {
+            for (j = 0; j < 100; j++)
+                (void) write(fd, b, sizeof(b));
+            nanosleep(&nap, NULL);
+        }
+    } else {
+        for (i = 0; i < minutes; i++) {
+            for (j = 0; j < number; j++)
+                 (void) write(fd, b, sizeof(b));
+        }
     }
+    log_times(log, name, &start);
     return 0;
 }
@@ -0,0 +1,134 @@
+/*
+ * mlfq.c
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Source file for the MLFQ ADT implementation. Contains an implementation
+ * of a generic multi-level FIFO queue, built from one CList per level.
+ *
+ * This is my own work.
+ */
+
+#include <stdlib.h>     /* Used for malloc(), free() */
+#include "clist.h"      /* CList ADT */
+#include "mlfq.h"       /* MLFQ ADT */
+
+
+/*
+ * Struct that represents the queue itself
+ */
+struct mlfq {
+    CList **levels;     /* One FIFO per level, level 0 first */
+    int nlevels;        /* Number of levels */
+    long size;          /* Total number of items */
+};
+
+
+MLFQ *mq_create(int nlevels) {
+
+    int i;
+
+    /* Allocate memory, initialize the members */
+    MLFQ *mq = (MLFQ *)malloc(sizeof(MLFQ));
+    if (mq == NULL)
+        return NULL;
+    mq->nlevels = nlevels;
+    mq->size = 0L;
+    if ((mq->levels = (CList **)malloc(sizeof(CList *) * nlevels)) == NULL) {
+        free(mq);
+        return NULL;
+    }
+
+    /* Create each level, undo everything if any allocation fails */
+    for (i = 0; i < nlevels; i++) {
+        if ((mq->levels[i] = cl_create()) == NULL) {
+            while (--i >= 0)
+                cl_destroy(mq->levels[i], NULL);
+            free(mq->levels);
+            free(mq);
+            return NULL;
+        }
+    }
+
+    return mq;
+}
+
+int mq_insert(MLFQ *mq, int level, void *item) {
+
+    /* Clamp the level into range */
+    if (level < 0)
+        level = 0;
+    if (level >= mq->nlevels)
+        level = mq->nlevels - 1;
+
+    if (!cl_insert(mq->levels[level], item))
+        return 0;
+    mq->size++;
+
+    return 1;
+}
+
+int mq_remove(MLFQ *mq, void **item) {
+
+    int i;
+
+    /* Take from the first non-empty level */
+    for (i = 0; i < mq->nlevels; i++) {
+        if (cl_remove(mq->levels[i], item)) {
+            mq->size--;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int mq_boost(MLFQ *mq, void (*fn)(void *)) {
+
+    void *item;
+    long n;
+    int i;
+
+    /* Items already on level 0 stay put, but still get the callback */
+    for (n = cl_size(mq->levels[0]); n > 0L; n--) {
+        cl_head(mq->levels[0], &item);
+        cl_rotate(mq->levels[0]);
+        if (fn != NULL)
+            (*fn)(item);
+    }
+
+    /* Append every lower level onto level 0, in priority order */
+    for (i = 1; i < mq->nlevels; i++) {
+        while (cl_head(mq->levels[i], &item)) {
+            if (!cl_insert(mq->levels[0], item))
+                return 0;
+            cl_remove(mq->levels[i], &item);
+            if (fn != NULL)
+                (*fn)(item);
+        }
+    }
+
+    return 1;
+}
+
+long mq_size(MLFQ *mq) {
+
+    return mq->size;
+}
+
+int mq_isEmpty(MLFQ *mq) {
+
+    return (mq->size == 0L);
+}
+
+void mq_destroy(MLFQ *mq, void (*destructor)(void *)) {
+
+    int i;
+
+    if (mq != NULL) {
+        for (i = 0; i < mq->nlevels; i++)
+            cl_destroy(mq->levels[i], destructor);
+        free(mq->levels);
+        free(mq);
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ * mlfq.h
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Header file for the MLFQ ADT implementation.
+ *
+ * This is my own work.
+ */
+
+#ifndef _MLFQ_H__
+#define _MLFQ_H__
+
+
+/*
+ * Data structure for a generic multi-level FIFO queue. Level 0 has the highest
+ * priority; items are always removed from the highest priority non-empty level.
+ */
+typedef struct mlfq MLFQ;
+
+
+/*
+ * Creates a new instance of the queue with 'nlevels' levels. Returns pointer
+ * to new instance, or NULL if allocation failed.
+ */
+MLFQ *mq_create(int nlevels);
+
+/*
+ * Inserts 'item' into the back of the specified level; levels outside of the
+ * queue's range are clamped to the nearest valid level.
+ *
+ * Returns 1 if insertion successful, 0 if not (allocation failed).
+ */
+int mq_insert(MLFQ *mq, int level, void *item);
+
+/*
+ * Removes the first item of the highest priority non-empty level, stores result
+ * into '*item'.
+ *
+ * Returns 1 if removal was successful, 0 if not (queue is empty).
+ */
+int mq_remove(MLFQ *mq, void **item);
+
+/*
+ * Moves every item into level 0, keeping them in priority order. If fn != NULL,
+ * it is invoked on each item that is moved.
+ *
+ * Returns 1 if successful, 0 if not (allocation failed).
+ */
+int mq_boost(MLFQ *mq, void (*fn)(void *));
+
+/*
+ * Returns the total number of items in the queue.
+ */
+long mq_size(MLFQ *mq);
+
+/*
+ * Returns 1/0 indicating whether the queue is currently empty.
+ */
+int mq_isEmpty(MLFQ *mq);
+
+/*
+ * Destroys the queue instance. If destructor != NULL, it is invoked on
+ * each item in the queue before destruction.
+ */
+void mq_destroy(MLFQ *mq, void (*destructor)(void *));
+
+
+#endif/* _MLFQ_H__ */
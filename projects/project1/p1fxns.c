@@ -33,6 +33,158 @@ int p1getline(int fd, char buf[], int size) {
     return i;
 }
 
+/*
+ *	P1Reader - buffered line reader over a file descriptor
+ *
+ *	bytes [start, end) of buf are read but not yet returned; one extra byte
+ *	past P1R_BUFSIZE leaves room to EOS-terminate a line that fills the
+ *	buffer. the byte overwritten by the last line's EOS is kept in saved,
+ *	and put back on the next call
+ */
+struct p1reader {
+    int fd;
+    int start;
+    int end;
+    int mark;		/* index of the last EOS written, -1 if none */
+    int eof;
+    char saved;
+    char buf[P1R_BUFSIZE + 1];
+};
+
+P1Reader *p1ropen(int fd) {
+    P1Reader *r = (P1Reader *)malloc(sizeof(P1Reader));
+
+    if (r != NULL) {
+        r->fd = fd;
+        r->start = r->end = 0;
+        r->mark = -1;
+        r->eof = 0;
+    }
+    return r;
+}
+
+char *p1rgetline(P1Reader *r, int *len) {
+    char *line;
+    int i, n;
+
+    if (r->mark != -1) {
+        r->buf[r->mark] = r->saved;
+        r->mark = -1;
+    }
+    for (i = r->start; ; ) {
+        /* complete line already buffered? */
+        while (i < r->end && r->buf[i] != '\n')
+            i++;
+        if (i < r->end) {
+            i++;
+            break;
+        }
+        /* last line without '\n', or a line as long as the buffer */
+        if (r->eof || r->end - r->start == P1R_BUFSIZE)
+            break;
+        /* move the partial line to the front, read another block */
+        if (r->start > 0) {
+            memmove(r->buf, r->buf + r->start, r->end - r->start);
+            i -= r->start;
+            r->end -= r->start;
+            r->start = 0;
+        }
+        n = read(r->fd, r->buf + r->end, P1R_BUFSIZE - r->end);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            *len = -1;
+            return NULL;
+        }
+        if (n == 0)
+            r->eof = 1;
+        r->end += n;
+    }
+    if (i == r->start) {
+        *len = 0;	/* end of file */
+        return NULL;
+    }
+    line = r->buf + r->start;
+    *len = i - r->start;
+    r->mark = i;
+    r->saved = r->buf[i];
+    r->buf[i] = '\0';
+    r->start = i;
+    return line;
+}
+
+void p1rclose(P1Reader *r) {
+    free(r);
+}
+
+/*
+ *	P1Writer - buffered writer over a file descriptor
+ *
+ *	bytes [0, len) of buf have been appended but not yet written
+ */
+struct p1writer {
+    int fd;
+    int len;
+    char buf[P1W_BUFSIZE];
+};
+
+P1Writer *p1wopen(int fd) {
+    P1Writer *w = (P1Writer *)malloc(sizeof(P1Writer));
+
+    if (w != NULL) {
+        w->fd = fd;
+        w->len = 0;
+    }
+    return w;
+}
+
+int p1wflush(P1Writer *w) {
+    int i, n;
+
+    for (i = 0; i < w->len; i += n) {
+        n = write(w->fd, w->buf + i, w->len - i);
+        if (n < 0) {
+            if (errno == EINTR) {
+                n = 0;
+                continue;
+            }
+            /* keep what was not written for the next attempt */
+            memmove(w->buf, w->buf + i, w->len - i);
+            w->len -= i;
+            return -1;
+        }
+    }
+    w->len = 0;
+    return 0;
+}
+
+int p1wwrite(P1Writer *w, void *buf, int n) {
+    char *p = (char *)buf;
+    int i, m;
+
+    for (i = 0; i < n; i += m) {
+        if (w->len == P1W_BUFSIZE && p1wflush(w) == -1)
+            return -1;
+        m = P1W_BUFSIZE - w->len;
+        if (m > n - i)
+            m = n - i;
+        memcpy(w->buf + w->len, p + i, m);
+        w->len += m;
+    }
+    return n;
+}
+
+void p1wputstr(P1Writer *w, char *s) {
+    p1wwrite(w, s, p1strlen(s));
+}
+
+void p1wclose(P1Writer *w) {
+    if (w != NULL) {
+        p1wflush(w);
+        free(w);
+    }
+}
+
 /*
  *	p1strchr - return the array index of leftmost occurrence of 'c' in 'buf'
  *
@@ -13,6 +13,80 @@
  */
 int p1getline(int fd, char buf[], int size);
 
+/*
+ *	P1Reader - buffered line reader over a file descriptor
+ *
+ *	reads the descriptor in blocks of P1R_BUFSIZE bytes, instead of one
+ *	read() per character as p1getline does
+ */
+#define P1R_BUFSIZE 65536
+typedef struct p1reader P1Reader;
+
+/*
+ *	p1ropen - create a reader for fd; fd is not closed by p1rclose
+ *
+ *	returns NULL if allocation failed
+ */
+P1Reader *p1ropen(int fd);
+
+/*
+ *	p1rgetline - return the next line from the reader, in place
+ *
+ *	the line, including its '\n' if any, is EOS-terminated and stays valid
+ *	(and may be modified) until the next call; its length is stored in *len.
+ *	a line longer than P1R_BUFSIZE is returned in pieces.
+ *	returns NULL at end of file (*len = 0) or on error (*len = -1, errno set);
+ *	if fd is non-blocking and no full line is ready, returns NULL with errno
+ *	EAGAIN, keeping any partial line for the next call
+ */
+char *p1rgetline(P1Reader *r, int *len);
+
+/*
+ *	p1rclose - destroy the reader
+ */
+void p1rclose(P1Reader *r);
+
+/*
+ *	P1Writer - buffered writer over a file descriptor
+ *
+ *	collects output in a buffer of P1W_BUFSIZE bytes and writes it out in
+ *	one write() when it fills, instead of one write() and fsync() per call
+ *	as p1putstr does
+ */
+#define P1W_BUFSIZE 65536
+typedef struct p1writer P1Writer;
+
+/*
+ *	p1wopen - create a writer for fd; fd is not closed by p1wclose
+ *
+ *	returns NULL if allocation failed
+ */
+P1Writer *p1wopen(int fd);
+
+/*
+ *	p1wwrite - append n bytes from buf to the writer
+ *
+ *	returns n, or -1 if a write() needed to make room failed (errno set)
+ */
+int p1wwrite(P1Writer *w, void *buf, int n);
+
+/*
+ *	p1wputstr - append string to the writer
+ */
+void p1wputstr(P1Writer *w, char *s);
+
+/*
+ *	p1wflush - write out everything buffered so far
+ *
+ *	returns 0 if successful, -1 if a write() failed (errno set)
+ */
+int p1wflush(P1Writer *w);
+
+/*
+ *	p1wclose - flush and destroy the writer
+ */
+void p1wclose(P1Writer *w);
+
 /*
  *	p1strchr - return the array index of leftmost occurrence of 'c' in 'buf'
  *
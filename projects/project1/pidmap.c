@@ -0,0 +1,187 @@
+/*
+ * pidmap.c
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Source file for the PidMap ADT implementation. Contains an implementation
+ * of an open-addressed hash table keyed by PID, using linear probing. Entries
+ * are removed by shifting later entries of the same probe run back into the
+ * freed slot, so no tombstones are left behind and removal stays O(1).
+ *
+ * This is my own work.
+ */
+
+#include <stdlib.h>     /* Used for malloc(), free() */
+#include "pidmap.h"     /* PidMap ADT */
+
+/* Smallest number of slots allocated */
+#define MIN_SLOTS 16L
+
+
+/*
+ * Slot stored inside the table; pid == 0 marks an empty slot
+ */
+typedef struct slot {
+    pid_t pid;                  /* The key */
+    void *item;                 /* The stored item */
+} Slot;
+
+/*
+ * Struct that represents the map itself
+ */
+struct pidmap {
+    Slot *slots;        /* Array of slots, length is a power of 2 */
+    long mask;          /* Number of slots minus one */
+    long size;          /* Number of mappings stored */
+};
+
+
+/*
+ * Local method that returns the home slot of 'pid'. PIDs are handed out
+ * sequentially, so they are scrambled with a multiplicative hash first.
+ */
+static long home(PidMap *pm, pid_t pid) {
+
+    return (long)(((unsigned long)pid * 2654435761UL) & (unsigned long)pm->mask);
+}
+
+/*
+ * Local method that reallocates the table with 'nslots' slots, re-inserting
+ * every mapping. Returns 1 if successful, 0 if allocation failed.
+ */
+static int resize(PidMap *pm, long nslots) {
+
+    Slot *old = pm->slots;
+    long i, j, oldlen = pm->mask + 1;
+
+    if ((pm->slots = (Slot *)calloc(nslots, sizeof(Slot))) == NULL) {
+        pm->slots = old;
+        return 0;
+    }
+    pm->mask = nslots - 1;
+
+    for (i = 0L; old != NULL && i < oldlen; i++) {
+        if (old[i].pid == 0)
+            continue;
+        for (j = home(pm, old[i].pid); pm->slots[j].pid != 0; j = (j + 1) & pm->mask)
+            ;
+        pm->slots[j] = old[i];
+    }
+    free(old);
+
+    return 1;
+}
+
+PidMap *pm_create(long capacity) {
+
+    long nslots = MIN_SLOTS;
+
+    /* Keep the load factor at or below 1/2 */
+    while (nslots < 2 * capacity)
+        nslots *= 2;
+
+    /* Allocate memory, initialize the members */
+    PidMap *pm = (PidMap *)malloc(sizeof(PidMap));
+    if (pm != NULL) {
+        pm->slots = NULL;
+        pm->mask = -1L;
+        pm->size = 0L;
+        if (!resize(pm, nslots)) {
+            free(pm);
+            pm = NULL;
+        }
+    }
+
+    return pm;
+}
+
+int pm_put(PidMap *pm, pid_t pid, void *item) {
+
+    long i;
+
+    /* Grow before the load factor exceeds 1/2 */
+    if (2 * (pm->size + 1) > pm->mask + 1)
+        if (!resize(pm, 2 * (pm->mask + 1)))
+            return 0;
+
+    for (i = home(pm, pid); pm->slots[i].pid != 0; i = (i + 1) & pm->mask) {
+        if (pm->slots[i].pid == pid) {
+            /* Already mapped, replace the item */
+            pm->slots[i].item = item;
+            return 1;
+        }
+    }
+    pm->slots[i].pid = pid;
+    pm->slots[i].item = item;
+    pm->size++;
+
+    return 1;
+}
+
+void *pm_get(PidMap *pm, pid_t pid) {
+
+    long i;
+
+    for (i = home(pm, pid); pm->slots[i].pid != 0; i = (i + 1) & pm->mask)
+        if (pm->slots[i].pid == pid)
+            return pm->slots[i].item;
+
+    return NULL;
+}
+
+void *pm_remove(PidMap *pm, pid_t pid) {
+
+    long i, j, h;
+    void *item;
+
+    /* Find the slot holding the pid */
+    for (i = home(pm, pid); pm->slots[i].pid != pid; i = (i + 1) & pm->mask)
+        if (pm->slots[i].pid == 0)
+            return NULL;
+    item = pm->slots[i].item;
+
+    /*
+     * Walk the rest of the probe run; any entry whose home slot does not lie
+     * cyclically within (i, j] can be moved back into the hole at i.
+     */
+    for (j = (i + 1) & pm->mask; pm->slots[j].pid != 0; j = (j + 1) & pm->mask) {
+        h = home(pm, pm->slots[j].pid);
+        if ((j > i) ? (h <= i || h > j) : (h <= i && h > j)) {
+            pm->slots[i] = pm->slots[j];
+            i = j;
+        }
+    }
+    pm->slots[i].pid = 0;
+    pm->slots[i].item = NULL;
+    pm->size--;
+
+    return item;
+}
+
+long pm_size(PidMap *pm) {
+
+    return pm->size;
+}
+
+void pm_apply(PidMap *pm, void (*fn)(void *)) {
+
+    long i;
+
+    for (i = 0L; i <= pm->mask; i++)
+        if (pm->slots[i].pid != 0)
+            (*fn)(pm->slots[i].item);
+}
+
+void pm_destroy(PidMap *pm, void (*destructor)(void *)) {
+
+    long i;
+
+    if (pm != NULL) {
+        /* Invoke destructor on each item if not NULL */
+        for (i = 0L; destructor != NULL && i <= pm->mask; i++)
+            if (pm->slots[i].pid != 0)
+                (*destructor)(pm->slots[i].item);
+        free(pm->slots);
+        free(pm);
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ * pidmap.h
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Header file for the PidMap ADT implementation.
+ *
+ * This is my own work.
+ */
+
+#ifndef _PIDMAP_H__
+#define _PIDMAP_H__
+
+#include <unistd.h>     /* Used for pid_t type */
+
+
+/*
+ * Data structure for a hash table that maps PIDs to generic items.
+ */
+typedef struct pidmap PidMap;
+
+
+/*
+ * Creates a new instance of the map, with room for at least 'capacity'
+ * entries before it needs to grow. Returns pointer to new instance, or
+ * NULL if allocation failed.
+ */
+PidMap *pm_create(long capacity);
+
+/*
+ * Maps 'pid' to 'item', replacing any item already mapped to 'pid'.
+ *
+ * Returns 1 if insertion successful, 0 if not (allocation failed).
+ */
+int pm_put(PidMap *pm, pid_t pid, void *item);
+
+/*
+ * Returns the item mapped to 'pid', or NULL if there is none.
+ */
+void *pm_get(PidMap *pm, pid_t pid);
+
+/*
+ * Removes the mapping for 'pid'. Never allocates or frees memory.
+ *
+ * Returns the item that was mapped to 'pid', or NULL if there was none.
+ */
+void *pm_remove(PidMap *pm, pid_t pid);
+
+/*
+ * Returns the number of mappings currently stored.
+ */
+long pm_size(PidMap *pm);
+
+/*
+ * Invokes 'fn' on each item in the map, in no particular order. 'fn' must
+ * not add or remove mappings.
+ */
+void pm_apply(PidMap *pm, void (*fn)(void *));
+
+/*
+ * Destroys the map instance. If destructor != NULL, it is invoked on
+ * each item in the map before destruction.
+ */
+void pm_destroy(PidMap *pm, void (*destructor)(void *));
+
+
+#endif/* _PIDMAP_H__ */
@@ -0,0 +1,170 @@
+/*
+ * policy_cfs.c
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Source file for the fair-share scheduling policy. Each process accumulates
+ * virtual runtime, the nanoseconds of CPU time it actually used divided by its
+ * '@weight=' from the workload file, and the lane always runs the process with
+ * the least. CPU time is polled by the scheduler before each call, so that a
+ * process which sleeps through its slice, or waits on I/O, is not charged for
+ * the wall time it held the lane. Processes are kept in a min-heap ordered by
+ * virtual runtime.
+ *
+ * This is my own work.
+ */
+
+#include <stdlib.h>     /* Used for malloc(), free(), NULL */
+#include "heap.h"       /* Heap ADT */
+#include "sched.h"      /* Scheduling policy interface */
+
+
+/*
+ * Struct that represents the fair-share queue of one lane
+ */
+typedef struct cfs_queue {
+    Heap *tree;                 /* Processes waiting for their turn, by virtual runtime */
+    unsigned long long min_vruntime;/* Least virtual runtime seen on the lane */
+    SchedConf *conf;            /* Scheduler settings */
+} CFSQueue;
+
+
+/*
+ * Orders two processes by virtual runtime, then by PID to break ties.
+ */
+static int cfs_compare(void *a, void *b) {
+
+    unsigned long long va = pr_vruntime((Process *)a), vb = pr_vruntime((Process *)b);
+
+    if (va != vb)
+        return (va < vb) ? -1 : 1;
+
+    return (int)(pr_pid((Process *)a) - pr_pid((Process *)b));
+}
+
+/*
+ * Charges the running process for the CPU time it used since it was last
+ * charged, scaled down by its weight. The lane's least virtual runtime only
+ * ever moves forward.
+ */
+static void cfs_account(CFSQueue *cq, Process *pr) {
+
+    unsigned long long cpu = pr_cputime(pr), min;
+    Process *next;
+
+    if (cpu > pr_charged(pr))
+        assign_vruntime(pr, pr_vruntime(pr) + (cpu - pr_charged(pr)) / pr_weight(pr));
+    assign_charged(pr, cpu);
+
+    min = pr_vruntime(pr);
+    if (hp_peek(cq->tree, (void **)&next) && pr_vruntime(next) < min)
+        min = pr_vruntime(next);
+    if (min > cq->min_vruntime)
+        cq->min_vruntime = min;
+}
+
+/*
+ * Creates the queue of one lane.
+ */
+static void *cfs_create(SchedConf *conf) {
+
+    /* Allocate memory, initialize the members */
+    CFSQueue *cq = (CFSQueue *)malloc(sizeof(CFSQueue));
+    if (cq != NULL) {
+        if ((cq->tree = hp_create(cfs_compare)) != NULL) {
+            cq->min_vruntime = 0ULL;
+            cq->conf = conf;
+        } else {
+            /* Allocation failed, free the struct */
+            free(cq);
+            cq = NULL;
+        }
+    }
+
+    return cq;
+}
+
+/*
+ * Every process is checked for preemption once per quantum.
+ */
+static void cfs_admit(void *q, Process *pr) {
+
+    CFSQueue *cq = (CFSQueue *)q;
+
+    assign_ticks(pr, cq->conf->quantum / cq->conf->slice);
+}
+
+/*
+ * Queues the process by virtual runtime. A process far behind the lane's least
+ * virtual runtime (new, or moved from another lane) is first brought to within
+ * one quantum of it, so that it cannot monopolize the lane while it catches up.
+ */
+static int cfs_enqueue(void *q, Process *pr) {
+
+    CFSQueue *cq = (CFSQueue *)q;
+    unsigned long long floor, window = cq->conf->quantum * 1000ULL;
+
+    floor = (cq->min_vruntime > window) ? (cq->min_vruntime - window) : 0ULL;
+    if (pr_vruntime(pr) < floor)
+        assign_vruntime(pr, floor);
+
+    return hp_insert(cq->tree, pr);
+}
+
+/*
+ * Takes the process with the least virtual runtime.
+ */
+static int cfs_pick_next(void *q, Process **pr) {
+
+    return hp_remove(((CFSQueue *)q)->tree, (void **)pr);
+}
+
+/*
+ * Returns the number of processes waiting.
+ */
+static long cfs_size(void *q) {
+
+    return hp_size(((CFSQueue *)q)->tree);
+}
+
+/*
+ * Charges the process for the time it ran; it keeps the lane unless another
+ * process now has less virtual runtime.
+ */
+static int cfs_on_tick(void *q, Process *pr) {
+
+    CFSQueue *cq = (CFSQueue *)q;
+    Process *next;
+
+    cfs_account(cq, pr);
+
+    return (hp_peek(cq->tree, (void **)&next) && pr_vruntime(next) >= pr_vruntime(pr));
+}
+
+/*
+ * Charges the process for the time it ran before blocking.
+ */
+static void cfs_on_block(void *q, Process *pr) {
+
+    cfs_account((CFSQueue *)q, pr);
+}
+
+/*
+ * Destroys the queue.
+ */
+static void cfs_destroy(void *q, void (*freeFxn)(void *)) {
+
+    CFSQueue *cq = (CFSQueue *)q;
+
+    if (cq != NULL) {
+        hp_destroy(cq->tree, freeFxn);
+        free(cq);
+    }
+}
+
+
+Policy cfs_policy = {
+    "cfs", 1,
+    cfs_create, cfs_admit, cfs_enqueue, cfs_pick_next, cfs_size,
+    cfs_on_tick, cfs_on_block, NULL, cfs_destroy
+};
@@ -0,0 +1,132 @@
+/*
+ * policy_edf.c
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Source file for the earliest deadline first scheduling policy. The lane
+ * runs the process with the earliest '@deadline=' from the workload file;
+ * processes without one run after the rest, in workload order. Deadlines are
+ * only compared when the running process's quantum expires, so the policy is
+ * not preemptive on arrival: a process queued with an earlier deadline waits
+ * for the rest of the running process's quantum, at most one quantum.
+ *
+ * This is my own work.
+ */
+
+#include <stdlib.h>     /* Used for malloc(), free(), NULL */
+#include "heap.h"       /* Heap ADT */
+#include "sched.h"      /* Scheduling policy interface */
+
+
+/*
+ * Struct that represents the deadline queue of one lane
+ */
+typedef struct edf_queue {
+    Heap *tree;                 /* Processes waiting for their turn, by deadline */
+    SchedConf *conf;            /* Scheduler settings */
+} EDFQueue;
+
+
+/*
+ * Returns the deadline of the process; one without a deadline is given the
+ * largest possible deadline, so that it sorts after every process with one.
+ */
+static unsigned long edf_key(Process *pr) {
+
+    return (pr_deadline(pr) != 0L) ? pr_deadline(pr) : (unsigned long)-1L;
+}
+
+int edf_compare(void *a, void *b) {
+
+    unsigned long da = edf_key((Process *)a), db = edf_key((Process *)b);
+
+    if (da != db)
+        return (da < db) ? -1 : 1;
+
+    return (int)(pr_pid((Process *)a) - pr_pid((Process *)b));
+}
+
+/*
+ * Creates the queue of one lane.
+ */
+static void *edf_create(SchedConf *conf) {
+
+    /* Allocate memory, initialize the members */
+    EDFQueue *eq = (EDFQueue *)malloc(sizeof(EDFQueue));
+    if (eq != NULL) {
+        if ((eq->tree = hp_create(edf_compare)) != NULL) {
+            eq->conf = conf;
+        } else {
+            /* Allocation failed, free the struct */
+            free(eq);
+            eq = NULL;
+        }
+    }
+
+    return eq;
+}
+
+/*
+ * Every process is checked for preemption once per quantum.
+ */
+static void edf_admit(void *q, Process *pr) {
+
+    EDFQueue *eq = (EDFQueue *)q;
+
+    assign_ticks(pr, eq->conf->quantum / eq->conf->slice);
+}
+
+/*
+ * Queues the process by deadline.
+ */
+static int edf_enqueue(void *q, Process *pr) {
+
+    return hp_insert(((EDFQueue *)q)->tree, pr);
+}
+
+/*
+ * Takes the process with the earliest deadline.
+ */
+static int edf_pick_next(void *q, Process **pr) {
+
+    return hp_remove(((EDFQueue *)q)->tree, (void **)pr);
+}
+
+/*
+ * Returns the number of processes waiting.
+ */
+static long edf_size(void *q) {
+
+    return hp_size(((EDFQueue *)q)->tree);
+}
+
+/*
+ * The process keeps the lane unless another process has an earlier deadline;
+ * this is the only point at which the running process is preempted.
+ */
+static int edf_on_tick(void *q, Process *pr) {
+
+    Process *next;
+
+    return (hp_peek(((EDFQueue *)q)->tree, (void **)&next) && edf_key(next) >= edf_key(pr));
+}
+
+/*
+ * Destroys the queue.
+ */
+static void edf_destroy(void *q, void (*freeFxn)(void *)) {
+
+    EDFQueue *eq = (EDFQueue *)q;
+
+    if (eq != NULL) {
+        hp_destroy(eq->tree, freeFxn);
+        free(eq);
+    }
+}
+
+
+Policy edf_policy = {
+    "edf", 0,
+    edf_create, edf_admit, edf_enqueue, edf_pick_next, edf_size,
+    edf_on_tick, NULL, NULL, edf_destroy
+};
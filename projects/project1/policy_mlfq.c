@@ -0,0 +1,179 @@
+/*
+ * policy_mlfq.c
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Source file for the multi-level feedback queue scheduling policy. Each level
+ * doubles the quantum of the one above it. A process that uses most of the CPU
+ * during its quantum drops a level, one that mostly sleeps rises a level, and
+ * every process is boosted back to the top level periodically.
+ *
+ * This is my own work.
+ */
+
+#include <stdlib.h>     /* Used for malloc(), free(), NULL */
+#include "mlfq.h"       /* MLFQ ADT */
+#include "sched.h"      /* Scheduling policy interface */
+
+/* Number of MLFQ levels */
+#define MLFQ_LEVELS 4
+/* Period (in ms) after which MLFQ boosts every process back to the top level */
+#define MLFQ_BOOST 2000
+/* CPU utilization (%) during a quantum at or above which MLFQ demotes a process */
+#define MLFQ_DEMOTE 50
+
+
+/*
+ * Struct that represents the feedback queue of one lane
+ */
+typedef struct mlfq_queue {
+    MLFQ *mlfq;                 /* Processes waiting for their turn, by level */
+    unsigned long long boosted; /* Time (in ns) of the last boost */
+    SchedConf *conf;            /* Scheduler settings */
+} MLFQQueue;
+
+
+/*
+ * Returns the number of ticks in a quantum at the given level. The top level
+ * gets half of the specified quantum, and each level below it gets twice as
+ * many ticks as the level above.
+ */
+static int level_ticks(MLFQQueue *mq, int level) {
+
+    int ticks = (mq->conf->quantum / mq->conf->slice) / 2;
+
+    return ((ticks > 0) ? ticks : 1) << level;
+}
+
+/*
+ * Puts the process back on the top level; it is given that level's quantum
+ * when it is next picked.
+ */
+static void mlfq_reset(void *pr) {
+
+    assign_level((Process *)pr, 0);
+}
+
+/*
+ * Creates the queue of one lane.
+ */
+static void *mlfq_create(SchedConf *conf) {
+
+    /* Allocate memory, initialize the members */
+    MLFQQueue *mq = (MLFQQueue *)malloc(sizeof(MLFQQueue));
+    if (mq != NULL) {
+        if ((mq->mlfq = mq_create(MLFQ_LEVELS)) != NULL) {
+            mq->boosted = sched_now();
+            mq->conf = conf;
+        } else {
+            /* Allocation failed, free the struct */
+            free(mq);
+            mq = NULL;
+        }
+    }
+
+    return mq;
+}
+
+/*
+ * New processes start on the top level.
+ */
+static void mlfq_admit(void *q, Process *pr) {
+
+    assign_level(pr, 0);
+    assign_ticks(pr, level_ticks((MLFQQueue *)q, 0));
+}
+
+/*
+ * Queues the process at the tail of its level.
+ */
+static int mlfq_enqueue(void *q, Process *pr) {
+
+    return mq_insert(((MLFQQueue *)q)->mlfq, pr_level(pr), pr);
+}
+
+/*
+ * Takes the process at the head of the highest non-empty level, with a fresh
+ * quantum of that level; it may have been boosted while it waited.
+ */
+static int mlfq_pick_next(void *q, Process **pr) {
+
+    MLFQQueue *mq = (MLFQQueue *)q;
+
+    if (!mq_remove(mq->mlfq, (void **)pr))
+        return 0;
+    assign_ticks(*pr, level_ticks(mq, pr_level(*pr)));
+
+    return 1;
+}
+
+/*
+ * Returns the number of processes waiting.
+ */
+static long mlfq_size(void *q) {
+
+    return mq_size(((MLFQQueue *)q)->mlfq);
+}
+
+/*
+ * Boosts the lane's processes back to the top level once the boost period has
+ * passed, preventing starvation of the lower levels. Then applies the feedback
+ * rules to the process: one that kept the CPU busy for most of its quantum is
+ * demoted one level, while one that spent most of it blocked is promoted one
+ * level. Its quantum is then set to that of its new level.
+ */
+static int mlfq_on_tick(void *q, Process *pr) {
+
+    MLFQQueue *mq = (MLFQQueue *)q;
+    unsigned long long now = sched_now();
+    int level;
+
+    /* Periodic boost; failing that only delays it, so the result is ignored */
+    if (now - mq->boosted >= MLFQ_BOOST * 1000000ULL && mq_boost(mq->mlfq, mlfq_reset)) {
+        mq->boosted = now;
+        assign_level(pr, 0);
+    }
+
+    level = pr_level(pr);
+    if (pr_cpu(pr) >= MLFQ_DEMOTE) {
+        if (level < MLFQ_LEVELS - 1)
+            level++;
+    } else if (level > 0) {
+        level--;
+    }
+    assign_level(pr, level);
+    assign_ticks(pr, level_ticks(mq, level));
+
+    return 0;
+}
+
+/*
+ * A process that blocks before its quantum runs out spent it mostly asleep, so
+ * it is promoted one level, and starts its new level's quantum afresh.
+ */
+static void mlfq_on_block(void *q, Process *pr) {
+
+    if (pr_level(pr) > 0)
+        assign_level(pr, pr_level(pr) - 1);
+    assign_ticks(pr, level_ticks((MLFQQueue *)q, pr_level(pr)));
+}
+
+/*
+ * Destroys the queue.
+ */
+static void mlfq_destroy(void *q, void (*freeFxn)(void *)) {
+
+    MLFQQueue *mq = (MLFQQueue *)q;
+
+    if (mq != NULL) {
+        mq_destroy(mq->mlfq, freeFxn);
+        free(mq);
+    }
+}
+
+
+Policy mlfq_policy = {
+    "mlfq", 1,
+    mlfq_create, mlfq_admit, mlfq_enqueue, mlfq_pick_next, mlfq_size,
+    mlfq_on_tick, mlfq_on_block, NULL, mlfq_destroy
+};
@@ -0,0 +1,188 @@
+/*
+ * policy_rr.c
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Source file for the round robin scheduling policies. Processes wait in a
+ * circular queue and each runs for its quantum in turn. The 'rr' policy gives
+ * every process the same quantum; the 'adaptive' policy (the default) adjusts
+ * each process's quantum based on how much I/O it does compared to the rest of
+ * the workload.
+ *
+ * This is my own work.
+ */
+
+#include <stdlib.h>     /* Used for malloc(), free(), NULL */
+#include "clist.h"      /* CList ADT */
+#include "sched.h"      /* Scheduling policy interface */
+
+
+/*
+ * Struct that represents the round robin queue of one lane
+ */
+typedef struct rr_queue {
+    CList *queue;               /* Processes waiting for their turn */
+    SchedConf *conf;            /* Scheduler settings */
+} RRQueue;
+
+
+/*
+ * Creates the queue of one lane.
+ */
+static void *rr_create(SchedConf *conf) {
+
+    /* Allocate memory, initialize the members */
+    RRQueue *rq = (RRQueue *)malloc(sizeof(RRQueue));
+    if (rq != NULL) {
+        if ((rq->queue = cl_create()) != NULL) {
+            rq->conf = conf;
+        } else {
+            /* Allocation failed, free the struct */
+            free(rq);
+            rq = NULL;
+        }
+    }
+
+    return rq;
+}
+
+/*
+ * Every process starts with the full quantum.
+ */
+static void rr_admit(void *q, Process *pr) {
+
+    RRQueue *rq = (RRQueue *)q;
+
+    assign_ticks(pr, rq->conf->quantum / rq->conf->slice);
+}
+
+/*
+ * Queues the process at the tail of the queue.
+ */
+static int rr_enqueue(void *q, Process *pr) {
+
+    return cl_insert(((RRQueue *)q)->queue, pr);
+}
+
+/*
+ * Takes the process at the head of the queue.
+ */
+static int rr_pick_next(void *q, Process **pr) {
+
+    return cl_remove(((RRQueue *)q)->queue, (void **)pr);
+}
+
+/*
+ * Returns the number of processes waiting.
+ */
+static long rr_size(void *q) {
+
+    return cl_size(((RRQueue *)q)->queue);
+}
+
+/*
+ * The process always goes to the back of the queue.
+ */
+static int rr_on_tick(UNUSED void *q, UNUSED Process *pr) {
+
+    return 0;
+}
+
+/*
+ * Destroys the queue.
+ */
+static void rr_destroy(void *q, void (*freeFxn)(void *)) {
+
+    RRQueue *rq = (RRQueue *)q;
+
+    if (rq != NULL) {
+        cl_destroy(rq->queue, freeFxn);
+        free(rq);
+    }
+}
+
+/*
+ * Re-configures the process's quantum slice, given the amount of
+ * I/O work it has previously performed. Depending on its I/O work
+ * compared to the workload's average I/O, the process will receive
+ * extra ticks, or have some ticks revoked.
+ *
+ * The design is simple: First calculate the ratio of the process's
+ * I/O work done to the workload's I/O. If the ratio falls within a
+ * defined mid-range, no changes are made to the number of ticks per
+ * time quantum. Otherwise, if the ratio falls below a limit, ticks
+ * are added; likewise, a higher I/O ratio will cause the process to
+ * lose ticks.
+ *
+ * The I/O work is sampled when the process information is printed, so
+ * nothing changes while USPS is quiet.
+ */
+#define TIER1 0.2F      /* The % of ticks to add/revoke for first check */
+#define TIER2 0.35F     /* The % of ticks to add/revoke for second check */
+#define TIER3 0.5F      /* The % of ticks to add/revoke for final check */
+static int adaptive_on_tick(void *q, Process *pr) {
+
+    static unsigned long avg_io = 0L;
+    static short first = 0;
+    RRQueue *rq = (RRQueue *)q;
+    unsigned long n_io = pr_io(pr);
+    float ratio = 1.0F;
+    int ticks = (rq->conf->quantum / rq->conf->slice), n_ticks = ticks;
+
+    /* Not sampled yet, keep the quantum as is */
+    if (n_io == 0L)
+        return 0;
+
+    /* First I/O read, add twice to get accurate average */
+    if (!first) {
+        avg_io += n_io;
+        first++;
+    }
+
+    /* Calculate average I/O and process's ratio */
+    avg_io += n_io;
+    avg_io /= 2;
+    ratio = ((float)n_io / avg_io);
+    /* Ratio is somewhat normal, return with no changes */
+    if (0.75F <= ratio && ratio <= 1.25F)
+        return 0;
+
+    if (ratio < 0.75F) {        /* Process is CPU-bound */
+        /* First check and tier increment */
+        if (0.5F <= ratio && ratio < 0.75F)
+            n_ticks += (int)(ticks * TIER1);
+        /* Second check and tier increment */
+        else if (0.25F <= ratio && ratio < 0.5F)
+            n_ticks += (int)(ticks * TIER2);
+        /* Final check and tier increment */
+        else
+            n_ticks += (int)(ticks * TIER3);
+    } else {    /* Process is I/O bound */
+        /* First check and tier decrement */
+        if (1.25F > ratio && ratio <= 1.5F)
+            n_ticks -= (int)(ticks * TIER1);
+        /* Second check and tier decrement */
+        else if (1.5F > ratio && ratio <= 1.75)
+            n_ticks -= (int)(ticks * TIER2);
+        /* Final check and tier decrement */
+        else
+            n_ticks -= (int)(ticks * TIER3);
+    }
+
+    /* Assign process new quantum ticks */
+    assign_ticks(pr, n_ticks);
+    return 0;
+}
+
+
+Policy rr_policy = {
+    "rr", 0,
+    rr_create, rr_admit, rr_enqueue, rr_pick_next, rr_size,
+    rr_on_tick, NULL, NULL, rr_destroy
+};
+
+Policy adaptive_policy = {
+    "adaptive", 0,
+    rr_create, rr_admit, rr_enqueue, rr_pick_next, rr_size,
+    adaptive_on_tick, NULL, NULL, rr_destroy
+};
@@ -0,0 +1,168 @@
+/*
+ * policy_sjf.c
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Source file for the shortest predicted burst scheduling policy. A burst is
+ * the CPU time a process used in its last quantum, and the prediction is an
+ * exponential average of its bursts. The lane runs the process with the
+ * shortest prediction; time spent waiting is credited against the prediction,
+ * so that long bursts cannot starve.
+ *
+ * This is my own work.
+ */
+
+#include <stdlib.h>     /* Used for malloc(), free(), NULL */
+#include "heap.h"       /* Heap ADT */
+#include "sched.h"      /* Scheduling policy interface */
+
+/* Weight (in 1/8ths) of the latest burst in the prediction */
+#define SJF_ALPHA 4
+/* Nanoseconds of waiting that offset one nanosecond of predicted burst */
+#define SJF_AGING 8
+
+
+/*
+ * Struct that represents the burst queue of one lane
+ */
+typedef struct sjf_queue {
+    Heap *tree;                 /* Processes waiting for their turn, by key */
+    SchedConf *conf;            /* Scheduler settings */
+} SJFQueue;
+
+
+/*
+ * Returns the predicted burst of the process, less one nanosecond for every
+ * SJF_AGING it has been waiting. The credit is counted from the zero of the
+ * monotonic clock instead, which orders the processes the same way at any
+ * moment without changing keys while they sit in the heap, and needs nothing
+ * but the process itself.
+ */
+static unsigned long long sjf_key(Process *pr) {
+
+    return pr_burst(pr) + pr_queued(pr) / SJF_AGING;
+}
+
+/*
+ * Orders two processes by their keys, then by PID to break ties.
+ */
+static int sjf_compare(void *a, void *b) {
+
+    unsigned long long ka = sjf_key((Process *)a), kb = sjf_key((Process *)b);
+
+    if (ka != kb)
+        return (ka < kb) ? -1 : 1;
+
+    return (int)(pr_pid((Process *)a) - pr_pid((Process *)b));
+}
+
+/*
+ * Updates the predicted burst of the process with the CPU time it used since
+ * it was last polled: the new prediction is SJF_ALPHA/8 of that burst plus the
+ * rest of the old prediction. The process is then considered queued as of now.
+ */
+static void sjf_predict(Process *pr) {
+
+    unsigned long long burst;
+
+    burst = pr_used(pr);
+    assign_burst(pr, (SJF_ALPHA * burst + (8 - SJF_ALPHA) * pr_burst(pr)) / 8);
+    assign_queued(pr, sched_now());
+}
+
+/*
+ * Creates the queue of one lane.
+ */
+static void *sjf_create(SchedConf *conf) {
+
+    /* Allocate memory, initialize the members */
+    SJFQueue *sq = (SJFQueue *)malloc(sizeof(SJFQueue));
+    if (sq != NULL) {
+        if ((sq->tree = hp_create(sjf_compare)) != NULL) {
+            sq->conf = conf;
+        } else {
+            /* Allocation failed, free the struct */
+            free(sq);
+            sq = NULL;
+        }
+    }
+
+    return sq;
+}
+
+/*
+ * With no bursts seen yet, a process is predicted to use half a quantum.
+ */
+static void sjf_admit(void *q, Process *pr) {
+
+    SJFQueue *sq = (SJFQueue *)q;
+
+    assign_ticks(pr, sq->conf->quantum / sq->conf->slice);
+    assign_burst(pr, sq->conf->quantum * 500ULL);
+    assign_queued(pr, sched_now());
+}
+
+/*
+ * Queues the process by key.
+ */
+static int sjf_enqueue(void *q, Process *pr) {
+
+    return hp_insert(((SJFQueue *)q)->tree, pr);
+}
+
+/*
+ * Takes the process with the smallest key.
+ */
+static int sjf_pick_next(void *q, Process **pr) {
+
+    return hp_remove(((SJFQueue *)q)->tree, (void **)pr);
+}
+
+/*
+ * Returns the number of processes waiting.
+ */
+static long sjf_size(void *q) {
+
+    return hp_size(((SJFQueue *)q)->tree);
+}
+
+/*
+ * Folds the quantum that just ended into the prediction; the process keeps the
+ * lane unless another process now sorts before it.
+ */
+static int sjf_on_tick(void *q, Process *pr) {
+
+    Process *next;
+
+    sjf_predict(pr);
+
+    return (hp_peek(((SJFQueue *)q)->tree, (void **)&next) && sjf_key(next) >= sjf_key(pr));
+}
+
+/*
+ * Folds the burst that ended when the process blocked into the prediction.
+ */
+static void sjf_on_block(UNUSED void *q, Process *pr) {
+
+    sjf_predict(pr);
+}
+
+/*
+ * Destroys the queue.
+ */
+static void sjf_destroy(void *q, void (*freeFxn)(void *)) {
+
+    SJFQueue *sq = (SJFQueue *)q;
+
+    if (sq != NULL) {
+        hp_destroy(sq->tree, freeFxn);
+        free(sq);
+    }
+}
+
+
+Policy sjf_policy = {
+    "sjf", 1,
+    sjf_create, sjf_admit, sjf_enqueue, sjf_pick_next, sjf_size,
+    sjf_on_tick, sjf_on_block, NULL, sjf_destroy
+};
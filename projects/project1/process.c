@@ -12,7 +12,7 @@
  * the solution.
  */
 
-#include <stdlib.h>     /* Used for malloc(), free() */
+#include <stdlib.h>     /* Used for malloc(), free(), NULL */
 #include "process.h"    /* Process ADT */
 #include "p1fxns.h"     /* Used for p1getword(), p1strlen(), p1strdup() */
 
@@ -23,15 +23,72 @@
 struct process {
     char **argv;                /* Array of program arguments, ends with NULL */
     pid_t pid;                  /* The process PID */
+    int pidfd;                  /* File descriptor referring to the child, or -1 */
+    int freezer;                /* Descriptor of its cgroup's cgroup.freeze, or -1 */
+    int lane;                   /* CPU the process is pinned to, or -1 */
+    int home;                   /* Index of the lane it last ran on */
+    int level;                  /* Priority level, 0 is the highest */
+    int weight;                 /* Relative CPU share under fair scheduling */
+    unsigned long deadline;     /* Deadline (in ms since start), 0 if none */
+    unsigned long runtime;      /* Estimated runtime (in ms), 0 if unknown */
+    unsigned long long vruntime;/* Virtual runtime (in ns) under fair scheduling */
+    unsigned long long charged; /* CPU time (in ns) already added to its virtual runtime */
+    unsigned long long start;   /* Time (in ns) the process was last started/resumed */
+    unsigned long long burst;   /* Predicted length (in ns) of its next CPU burst */
+    unsigned long long queued;  /* Time (in ns) the process was last queued */
     int status;                 /* The process's status; WAITING, ALIVE, or DEAD */
     int ticks;                  /* Quantum ticks left remaining */
     int nticks;                 /* Max quantum ticks allocated to this process */
-    unsigned long prev_jfs;     /* Previous CPU jiffies */
-    unsigned long curr_jfs;     /* Current CPU jiffies */
-    unsigned long prev_util;    /* Previous utilization clokc ticks */
-    unsigned long curr_util;    /* Current utilization clokc ticks */
+    unsigned long long prev_time;/* Time (in ns) of the previous CPU poll */
+    unsigned long long curr_time;/* Time (in ns) of the last CPU poll */
+    unsigned long long prev_cpu;/* CPU time (in ns) used as of the previous poll */
+    unsigned long long curr_cpu;/* CPU time (in ns) used as of the last poll */
+    unsigned long io;           /* I/O work done, as of the last poll */
+    unsigned long rss;          /* Resident set size (in bytes), as of the last poll */
+    char *name;                 /* Name of the job in its DAG, or NULL */
+    char *after;                /* Names of the jobs it runs after, or NULL */
 };
 
+/*
+ * Local method to extract the scheduling attributes at the front of the given
+ * line, written as '@key=value' words, into the process. Unknown attributes
+ * are ignored. Returns the index into the line at which the program starts,
+ * -1 if allocation failed.
+ */
+static int extract_attrs(Process *pr, char *line) {
+
+    int index = 0, next;
+    char word[1024];
+
+    while ((next = p1getword(line, index, word)) != -1 && word[0] == '@') {
+        if (p1strneq(word, "@weight=", 8)) {
+            /* Relative CPU share, must be positive */
+            pr->weight = p1atoi(word + 8);
+            if (pr->weight < 1)
+                pr->weight = 1;
+        } else if (p1strneq(word, "@deadline=", 10)) {
+            /* Completion deadline, in ms since the workload started */
+            pr->deadline = (unsigned long)p1atoi(word + 10);
+        } else if (p1strneq(word, "@runtime=", 9)) {
+            /* Estimated runtime, in ms */
+            pr->runtime = (unsigned long)p1atoi(word + 9);
+        } else if (p1strneq(word, "@name=", 6)) {
+            /* Name other jobs may refer to; the last one given is kept */
+            free(pr->name);
+            if ((pr->name = p1strdup(word + 6)) == NULL)
+                return -1;
+        } else if (p1strneq(word, "@after=", 7)) {
+            /* Comma separated names of the jobs it runs after */
+            free(pr->after);
+            if ((pr->after = p1strdup(word + 7)) == NULL)
+                return -1;
+        }
+        index = next;
+    }
+
+    return index;
+}
+
 /*
  * Local method to extract the program args from the given line.
  * Allocates a char ** array to store the args, ending with NULL; to
@@ -72,18 +129,32 @@ Process *malloc_pr(char *prog) {
     Process *pr = (Process *)malloc(sizeof(Process));
     if (pr != NULL) {
 
-        /* Obtains char array of program arguments */
-        char **args = extract_argv(prog);
+        /* Obtains the attributes, then char array of program arguments */
+        pr->weight = 1;
+        pr->deadline = pr->runtime = 0L;
+        pr->name = pr->after = NULL;
+        int index = extract_attrs(pr, prog);
+        char **args = (index != -1) ? extract_argv(prog + index) : NULL;
         if (args != NULL) {
             /* Initialzie rest of members */
             pr->argv = args;
             pr->pid = 0;
+            pr->pidfd = -1;
+            pr->freezer = -1;
+            pr->lane = -1;
+            pr->home = 0;
+            pr->level = 0;
+            pr->vruntime = pr->charged = pr->start = 0ULL;
+            pr->burst = pr->queued = 0ULL;
+            pr->io = pr->rss = 0L;
             pr->ticks = pr->nticks = 0;
             pr->status = WAITING;
-            pr->prev_jfs = pr->curr_jfs = 0L;
-            pr->prev_util = pr->curr_util = 0L;
+            pr->prev_time = pr->curr_time = 0ULL;
+            pr->prev_cpu = pr->curr_cpu = 0ULL;
         } else {
             /* Allocation failed, free the struct */
+            free(pr->name);
+            free(pr->after);
             free(pr);
             pr = NULL;
         }
@@ -102,6 +173,56 @@ void assign_pid(Process *pr, pid_t pid) {
     pr->pid = pid;
 }
 
+void assign_pidfd(Process *pr, int fd) {
+
+    pr->pidfd = fd;
+}
+
+void assign_freezer(Process *pr, int fd) {
+
+    pr->freezer = fd;
+}
+
+void assign_lane(Process *pr, int cpu) {
+
+    pr->lane = cpu;
+}
+
+void assign_home(Process *pr, int lane) {
+
+    pr->home = lane;
+}
+
+void assign_level(Process *pr, int level) {
+
+    pr->level = level;
+}
+
+void assign_vruntime(Process *pr, unsigned long long vruntime) {
+
+    pr->vruntime = vruntime;
+}
+
+void assign_charged(Process *pr, unsigned long long charged) {
+
+    pr->charged = charged;
+}
+
+void assign_start(Process *pr, unsigned long long start) {
+
+    pr->start = start;
+}
+
+void assign_burst(Process *pr, unsigned long long burst) {
+
+    pr->burst = burst;
+}
+
+void assign_queued(Process *pr, unsigned long long queued) {
+
+    pr->queued = queued;
+}
+
 void assign_ticks(Process *pr, int nticks) {
 
     pr->ticks = pr->nticks = nticks;
@@ -122,6 +243,86 @@ pid_t pr_pid(Process *pr) {
     return pr->pid;
 }
 
+int pr_pidfd(Process *pr) {
+
+    return pr->pidfd;
+}
+
+int pr_freezer(Process *pr) {
+
+    return pr->freezer;
+}
+
+int pr_lane(Process *pr) {
+
+    return pr->lane;
+}
+
+int pr_home(Process *pr) {
+
+    return pr->home;
+}
+
+int pr_level(Process *pr) {
+
+    return pr->level;
+}
+
+int pr_ticks(Process *pr) {
+
+    return pr->nticks;
+}
+
+unsigned long long pr_vruntime(Process *pr) {
+
+    return pr->vruntime;
+}
+
+unsigned long long pr_charged(Process *pr) {
+
+    return pr->charged;
+}
+
+unsigned long long pr_start(Process *pr) {
+
+    return pr->start;
+}
+
+unsigned long long pr_burst(Process *pr) {
+
+    return pr->burst;
+}
+
+unsigned long long pr_queued(Process *pr) {
+
+    return pr->queued;
+}
+
+int pr_weight(Process *pr) {
+
+    return pr->weight;
+}
+
+unsigned long pr_deadline(Process *pr) {
+
+    return pr->deadline;
+}
+
+unsigned long pr_runtime(Process *pr) {
+
+    return pr->runtime;
+}
+
+char *pr_name(Process *pr) {
+
+    return pr->name;
+}
+
+char *pr_after(Process *pr) {
+
+    return pr->after;
+}
+
 int pr_status(Process *pr) {
 
     return pr->status;
@@ -137,25 +338,53 @@ void pr_kill(Process *pr) {
     pr->status = DEAD;
 }
 
-void pr_poll_jiffies(Process *pr, unsigned long jiffies) {
+void pr_poll_cpu(Process *pr, unsigned long long time, unsigned long long cpu) {
+
+    pr->prev_time = pr->curr_time;
+    pr->curr_time = time;
+    pr->prev_cpu = pr->curr_cpu;
+    pr->curr_cpu = cpu;
+}
+
+void pr_poll_io(Process *pr, unsigned long io) {
+
+    pr->io = io;
+}
+
+unsigned long pr_io(Process *pr) {
 
-    unsigned long temp = pr->curr_jfs;
-    pr->prev_jfs = temp;
-    pr->curr_jfs = jiffies;
+    return pr->io;
 }
 
-void pr_poll_util(Process *pr, unsigned long util) {
+void pr_poll_rss(Process *pr, unsigned long rss) {
 
-    unsigned long temp = pr->curr_util;
-    pr->prev_util = temp;
-    pr->curr_util = util;
+    pr->rss = rss;
+}
+
+unsigned long pr_rss(Process *pr) {
+
+    return pr->rss;
+}
+
+unsigned long long pr_used(Process *pr) {
+
+    /* A job's total may drop when one of its processes is reaped outside of it */
+    return (pr->curr_cpu > pr->prev_cpu) ? (pr->curr_cpu - pr->prev_cpu) : 0ULL;
+}
+
+unsigned long long pr_cputime(Process *pr) {
+
+    return pr->curr_cpu;
 }
 
 int pr_cpu(Process *pr) {
 
-    int res = 100 * (((float)pr->curr_util - pr->prev_util) /
-                ((float)pr->curr_jfs - pr->prev_jfs));
-    
+    /* No time has passed between the polls */
+    if (pr->curr_time <= pr->prev_time)
+        return 0;
+
+    int res = (int)((100 * pr_used(pr)) / (pr->curr_time - pr->prev_time));
+
     return (res > 100) ? 100 : res;
 }
 
@@ -169,6 +398,8 @@ void free_pr(Process *pr) {
             free(pr->argv[i]);
         /* Free the rest of the members */
         free(pr->argv);
+        free(pr->name);
+        free(pr->after);
         free(pr);
     }
 }
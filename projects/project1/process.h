@@ -33,6 +33,15 @@ typedef struct process Process;
  * The line given represents a program invoked on the command line (ex.
  * 'echo this', 'date', 'ls -lh /home/', etc). Returns a pointer to the
  * new instance, NULL if allocation failed.
+ *
+ * The program may be preceded by scheduling attributes, written as
+ * '@key=value' words (ex. '@weight=2 ./cpubound -minutes 1'). Supported:
+ *   @weight=<n>  : Relative CPU share under fair scheduling (default 1).
+ *   @deadline=<ms> : Time (since the workload started) it must finish by.
+ *   @runtime=<ms>  : Estimate of the CPU time it needs.
+ *   @name=<name>   : Name that later jobs may run after.
+ *   @after=<names> : Comma separated names of earlier jobs it runs after.
+ * Unknown attributes are ignored.
  */
 Process *malloc_pr(char *prog);
 
@@ -50,6 +59,59 @@ char **pr_argv(Process *pr);
  */
 void assign_pid(Process *pr, pid_t pid);
 
+/*
+ * Assigns the pidfd 'fd' (a file descriptor referring to the running
+ * child) to the process instance; -1 if none is held.
+ */
+void assign_pidfd(Process *pr, int fd);
+
+/*
+ * Assigns the descriptor 'fd' of the cgroup.freeze file of the cgroup the
+ * process's job runs in; -1 if it has none.
+ */
+void assign_freezer(Process *pr, int fd);
+
+/*
+ * Records the CPU the process has been pinned to; -1 if it has not been.
+ */
+void assign_lane(Process *pr, int cpu);
+
+/*
+ * Records the index of the lane the process last ran on, before it blocked.
+ */
+void assign_home(Process *pr, int lane);
+
+/*
+ * Assigns the process's priority level, used by multi-level policies.
+ */
+void assign_level(Process *pr, int level);
+
+/*
+ * Stores the virtual runtime (in ns) of the process, used for fair scheduling.
+ */
+void assign_vruntime(Process *pr, unsigned long long vruntime);
+
+/*
+ * Stores the CPU time (in ns) of the process that its virtual runtime already
+ * accounts for, used for fair scheduling.
+ */
+void assign_charged(Process *pr, unsigned long long charged);
+
+/*
+ * Stores the time (in ns) at which the process was last started or resumed.
+ */
+void assign_start(Process *pr, unsigned long long start);
+
+/*
+ * Stores the predicted length (in ns) of the process's next CPU burst.
+ */
+void assign_burst(Process *pr, unsigned long long burst);
+
+/*
+ * Stores the time (in ns) at which the process was last queued to wait for a CPU.
+ */
+void assign_queued(Process *pr, unsigned long long queued);
+
 /*
  * Assign the number of quantum ticks to the specified process.
  */
@@ -67,6 +129,91 @@ int decr_tick(Process *pr);
  */
 pid_t pr_pid(Process *pr);
 
+/*
+ * Returns the pidfd of the specified process, -1 if none is held.
+ */
+int pr_pidfd(Process *pr);
+
+/*
+ * Returns the cgroup.freeze descriptor of the specified process, -1 if none.
+ */
+int pr_freezer(Process *pr);
+
+/*
+ * Returns the CPU the process has been pinned to, -1 if it has not been.
+ */
+int pr_lane(Process *pr);
+
+/*
+ * Returns the index of the lane the process last ran on, as last assigned; 0 if
+ * it was never assigned.
+ */
+int pr_home(Process *pr);
+
+/*
+ * Returns the process's priority level; 0 (the highest) for new processes.
+ */
+int pr_level(Process *pr);
+
+/*
+ * Returns the number of ticks in the process's quantum, as last assigned.
+ */
+int pr_ticks(Process *pr);
+
+/*
+ * Returns the virtual runtime (in ns) of the process.
+ */
+unsigned long long pr_vruntime(Process *pr);
+
+/*
+ * Returns the CPU time (in ns) of the process that its virtual runtime already
+ * accounts for.
+ */
+unsigned long long pr_charged(Process *pr);
+
+/*
+ * Returns the time (in ns) at which the process was last started or resumed.
+ */
+unsigned long long pr_start(Process *pr);
+
+/*
+ * Returns the predicted length (in ns) of the process's next CPU burst.
+ */
+unsigned long long pr_burst(Process *pr);
+
+/*
+ * Returns the time (in ns) at which the process was last queued to wait for a CPU.
+ */
+unsigned long long pr_queued(Process *pr);
+
+/*
+ * Returns the process's relative CPU share, from its '@weight=' attribute.
+ */
+int pr_weight(Process *pr);
+
+/*
+ * Returns the process's deadline (in ms since the workload started), from its
+ * '@deadline=' attribute; 0 if it has none.
+ */
+unsigned long pr_deadline(Process *pr);
+
+/*
+ * Returns the process's estimated runtime (in ms), from its '@runtime='
+ * attribute; 0 if it has none.
+ */
+unsigned long pr_runtime(Process *pr);
+
+/*
+ * Returns the process's name, from its '@name=' attribute; NULL if it has none.
+ */
+char *pr_name(Process *pr);
+
+/*
+ * Returns the comma separated names of the jobs the process runs after, from
+ * its '@after=' attribute; NULL if it has none.
+ */
+char *pr_after(Process *pr);
+
 /*
  * Returns the process's current status; either WAITING, ALIVE, or
  * DEAD. Uses the macros defined in process.h
@@ -84,18 +231,47 @@ void pr_wake(Process *pr);
 void pr_kill(Process *pr);
 
 /*
- * Stores the jiffies amount into the process, used for CPU calculation.
+ * Stores the CPU time (in ns) the process has used so far, sampled at 'time'
+ * (in ns), used for CPU calculation. Once the process has exited, its exact
+ * total is polled one last time.
+ */
+void pr_poll_cpu(Process *pr, unsigned long long time, unsigned long long cpu);
+
+/*
+ * Stores the amount of I/O work the process has done so far.
+ */
+void pr_poll_io(Process *pr, unsigned long io);
+
+/*
+ * Returns the amount of I/O work the process had done as of the last poll;
+ * 0 if it has not been polled.
+ */
+unsigned long pr_io(Process *pr);
+
+/*
+ * Stores the resident set size (in bytes) of the process's job.
+ */
+void pr_poll_rss(Process *pr, unsigned long rss);
+
+/*
+ * Returns the resident set size (in bytes) of the process's job as of the last
+ * poll; 0 if it has not been polled.
+ */
+unsigned long pr_rss(Process *pr);
+
+/*
+ * Returns the CPU time (in ns) the process used between the last two polls.
  */
-void pr_poll_jiffies(Process *pr, unsigned long jiffies);
+unsigned long long pr_used(Process *pr);
 
 /*
- * Stores the utilization clock ticks into the process, used for CPU
- * calculation.
+ * Returns the CPU time (in ns) the process had used as of the last poll.
  */
-void pr_poll_util(Process *pr, unsigned long util);
+unsigned long long pr_cputime(Process *pr);
 
 /*
- * Calculates the CPU utilization for this process.
+ * Calculates the CPU utilization (%) for this process between the last two
+ * polls.
  */
 int pr_cpu(Process *pr);
 
@@ -0,0 +1,66 @@
+/*
+ * record.h
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Header file describing the records USPS v5 reports about processes, and the
+ * layout of its binary report format (--format=binary), so that other programs
+ * may read it. A binary report is one RecHeader followed by any number of
+ * Records, all in the byte order of the machine that wrote them.
+ *
+ * This is my own work.
+ */
+
+#ifndef _RECORD_H__
+#define _RECORD_H__
+
+#include <stdint.h>     /* Used for uint32_t, uint64_t */
+
+/* First bytes of every binary report */
+#define REC_MAGIC "USPSREC2"
+/* Length of the command line kept in a binary record, including its '\0' */
+#define REC_CMDLEN 64
+
+
+/*
+ * Events a process is reported for.
+ */
+typedef enum { R_RUN, R_STOP, R_BLOCK, R_EXIT } Event;
+
+/*
+ * Written once, at the start of a binary report.
+ */
+typedef struct rec_header {
+    char magic[8];              /* REC_MAGIC, not '\0' terminated */
+    uint32_t size;              /* Size of one Record, in bytes */
+    uint32_t clk_tck;           /* Clock ticks per second, to convert the times */
+} RecHeader;
+
+/*
+ * One reported event, with the counters sampled from /proc right after it. A
+ * process's last record is for R_EXIT, when /proc can no longer be sampled.
+ */
+typedef struct record {
+    uint64_t time;              /* Nanoseconds since the workload started */
+    uint64_t syscr;             /* Read system calls */
+    uint64_t syscw;             /* Write system calls */
+    uint64_t rchar;             /* Bytes read */
+    uint64_t wchar;             /* Bytes written */
+    uint64_t read_bytes;        /* Bytes fetched from storage */
+    uint64_t write_bytes;       /* Bytes sent to storage */
+    uint64_t majflt;            /* Major faults */
+    uint64_t utime;             /* Time spent in user mode, in clock ticks */
+    uint64_t stime;             /* Time spent in kernel mode, in clock ticks */
+    uint64_t vsize;             /* Virtual memory size, in bytes */
+    uint64_t rss;               /* Resident set size, in bytes */
+    uint64_t cpu_ns;            /* CPU time used so far, in ns; exact on R_EXIT */
+    uint32_t pid;               /* PID of the process */
+    uint32_t event;             /* An Event; after R_EXIT only 'cpu_ns' is set */
+    uint32_t cpu;               /* CPU utilization % over the last quantum */
+    char state;                 /* R, S, D, T, Z, ... */
+    char pad[3];                /* Always zero */
+    char cmd[REC_CMDLEN];       /* Command line, cut short if needed */
+} Record;
+
+
+#endif/* _RECORD_H__ */
@@ -0,0 +1,113 @@
+/*
+ * ring.c
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Source file for the Ring ADT implementation. The indices count records ever
+ * pushed and popped, and are masked into the array, whose length is a power of
+ * 2. The producer publishes a record by storing the tail with release order
+ * after copying it in, and the consumer frees a slot by storing the head the
+ * same way after copying it out; each side loads the other's index with acquire
+ * order, so that it never sees a slot before the copy into or out of it is done.
+ *
+ * This is my own work.
+ */
+
+#include <stdatomic.h>  /* Used for atomic_load_explicit(), atomic_store_explicit() */
+#include <stdlib.h>     /* Used for malloc(), free(), NULL */
+#include <string.h>     /* Used for memcpy() */
+#include "ring.h"       /* Ring ADT */
+
+/* Smallest number of records allocated */
+#define MIN_RECORDS 16L
+/* Assumed cache line size, keeps the indices from sharing a line */
+#define CACHE_LINE 64
+
+
+/*
+ * Struct that represents the ring itself
+ */
+struct ring {
+    _Alignas(CACHE_LINE) atomic_ulong head;     /* Records popped, written by the consumer */
+    _Alignas(CACHE_LINE) atomic_ulong tail;     /* Records pushed, written by the producer */
+    _Alignas(CACHE_LINE) atomic_long dropped;   /* Records dropped, written by the producer */
+    unsigned long mask;                         /* Number of records minus one */
+    size_t size;                                /* Size of one record */
+    char *records;                              /* Array of records */
+};
+
+
+Ring *rg_create(long capacity, size_t size) {
+
+    Ring *rg;
+    long nrecords = MIN_RECORDS;
+
+    while (nrecords < capacity)
+        nrecords *= 2;
+
+    /* Allocate memory, initialize the members */
+    if ((rg = (Ring *)aligned_alloc(CACHE_LINE, sizeof(Ring))) != NULL) {
+        if ((rg->records = (char *)malloc(nrecords * size)) != NULL) {
+            atomic_init(&rg->head, 0UL);
+            atomic_init(&rg->tail, 0UL);
+            atomic_init(&rg->dropped, 0L);
+            rg->mask = (unsigned long)(nrecords - 1);
+            rg->size = size;
+        } else {
+            /* Allocation failed, free the struct */
+            free(rg);
+            rg = NULL;
+        }
+    }
+
+    return rg;
+}
+
+int rg_push(Ring *rg, void *rec) {
+
+    unsigned long tail = atomic_load_explicit(&rg->tail, memory_order_relaxed);
+
+    /* Full, drop the record rather than wait for the consumer */
+    if (tail - atomic_load_explicit(&rg->head, memory_order_acquire) > rg->mask) {
+        atomic_store_explicit(&rg->dropped,
+            atomic_load_explicit(&rg->dropped, memory_order_relaxed) + 1, memory_order_relaxed);
+        return 0;
+    }
+
+    memcpy(rg->records + (tail & rg->mask) * rg->size, rec, rg->size);
+    atomic_store_explicit(&rg->tail, tail + 1, memory_order_release);
+
+    return 1;
+}
+
+int rg_full(Ring *rg) {
+
+    return (atomic_load_explicit(&rg->tail, memory_order_relaxed) -
+        atomic_load_explicit(&rg->head, memory_order_acquire) > rg->mask);
+}
+
+int rg_pop(Ring *rg, void *rec) {
+
+    unsigned long head = atomic_load_explicit(&rg->head, memory_order_relaxed);
+
+    if (head == atomic_load_explicit(&rg->tail, memory_order_acquire))
+        return 0;
+
+    memcpy(rec, rg->records + (head & rg->mask) * rg->size, rg->size);
+    atomic_store_explicit(&rg->head, head + 1, memory_order_release);
+
+    return 1;
+}
+
+long rg_dropped(Ring *rg) {
+
+    return atomic_load_explicit(&rg->dropped, memory_order_relaxed);
+}
+
+void rg_destroy(Ring *rg) {
+
+    if (rg != NULL) {
+        free(rg->records);
+        free(rg);
+    }
+}
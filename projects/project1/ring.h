@@ -0,0 +1,65 @@
+/*
+ * ring.h
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Header file for the Ring ADT implementation, a bounded queue of fixed size
+ * records shared by exactly one producer thread and one consumer thread. It
+ * needs no locks: each side only ever writes its own index, and the records
+ * are copied in and out, so neither side allocates memory.
+ *
+ * This is my own work.
+ */
+
+#ifndef _RING_H__
+#define _RING_H__
+
+#include <stddef.h>     /* Used for size_t type */
+
+
+/*
+ * Data structure for a single producer, single consumer ring buffer.
+ */
+typedef struct ring Ring;
+
+
+/*
+ * Creates a new instance of the ring, with room for at least 'capacity' records
+ * of 'size' bytes each. Returns pointer to new instance, or NULL if allocation
+ * failed.
+ */
+Ring *rg_create(long capacity, size_t size);
+
+/*
+ * Copies the record at 'rec' into the ring. May only be called by the producer.
+ *
+ * Returns 1 if successful, 0 if not (the ring is full, the record is dropped).
+ */
+int rg_push(Ring *rg, void *rec);
+
+/*
+ * Returns 1 if the ring is full, so that a push would drop the record, 0 if
+ * not. May only be called by the producer.
+ */
+int rg_full(Ring *rg);
+
+/*
+ * Copies the oldest record in the ring into 'rec' and removes it. May only be
+ * called by the consumer.
+ *
+ * Returns 1 if successful, 0 if not (the ring is empty).
+ */
+int rg_pop(Ring *rg, void *rec);
+
+/*
+ * Returns the number of records that were dropped because the ring was full.
+ */
+long rg_dropped(Ring *rg);
+
+/*
+ * Destroys the ring instance. Neither thread may be using it any longer.
+ */
+void rg_destroy(Ring *rg);
+
+
+#endif/* _RING_H__ */
@@ -0,0 +1,594 @@
+/*
+ * sampler.c
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Source file for the /proc sampler ADT implementation. The files of a process
+ * are opened once and reread from offset 0 with a single pread() each time. The
+ * contents are parsed in place by a scanner that knows the layout of each file,
+ * instead of being split into words.
+ *
+ * The other processes of a job are found in the cgroup.procs file of its cgroup,
+ * or else by walking down from its leader through /proc/<pid>/task/<pid>/children,
+ * which lists the children of a process's main thread. That file is not there
+ * on every kernel (CONFIG_PROC_CHILDREN), and without it /proc is scanned for
+ * processes in the leader's process group instead, since a process group has no
+ * index of its own. The files of each process found are kept open like those of
+ * the leader, and carried over from one list to the next. The list is kept for
+ * MEMBERS_PERIOD ms, unless the leader is seen sleeping, as a shell waiting for
+ * the program it just forked is.
+ *
+ * This is my own work.
+ */
+
+#include <dirent.h>     /* Used for opendir(), readdir(), closedir() */
+#include <fcntl.h>      /* Used for open(), O_CLOEXEC */
+#include <stdlib.h>     /* Used for malloc(), free(), NULL */
+#include <time.h>       /* Used for clock_gettime(), CLOCK_MONOTONIC */
+#include "p1fxns.h"     /* Used for p1strcpy(), p1strcat(), p1itoa(), ... */
+#include "sampler.h"    /* Sampler ADT */
+
+/* Size of the buffer each file is read into */
+#define BUFFER_SIZE 1024
+/* Longest command line kept */
+#define CMDLINE_SIZE 2048
+/* Size of the buffer cgroup.procs is read into */
+#define PROCS_SIZE 8192
+/* Most processes of a job sampled besides its leader */
+#define MAX_MEMBERS 256
+/* Period (in ms) between refreshes of a job's list of processes */
+#define MEMBERS_PERIOD 100
+
+
+/*
+ * Another process of a job, with its /proc files kept open
+ */
+typedef struct member {
+    pid_t pid;                  /* Its PID */
+    int stat_fd;                /* Descriptor of /proc/<pid>/stat */
+    int io_fd;                  /* Descriptor of /proc/<pid>/io, or -1 */
+    int sched_fd;               /* Descriptor of /proc/<pid>/schedstat, or -1 */
+    int children_fd;            /* Descriptor of its children file, or -1 */
+} Member;
+
+/*
+ * Struct that represents the sampler itself
+ */
+struct sampler {
+    pid_t pid;                  /* PID of the process sampled */
+    int stat_fd;                /* Descriptor of /proc/<pid>/stat */
+    int io_fd;                  /* Descriptor of /proc/<pid>/io, or -1 */
+    int sched_fd;               /* Descriptor of /proc/<pid>/schedstat, or -1 */
+    char *cmdline;              /* Cached command line, NULL until first read */
+    char comm[32];              /* Command name the command line was cached for */
+    int job;                    /* 1 if the whole job is sampled, 0 if not */
+    int procs_fd;               /* Descriptor of the job's cgroup.procs, or -1 */
+    int children_fd;            /* Descriptor of the leader's children file, or -1 */
+    Member *members;            /* Other processes of the job, NULL unless a job */
+    int nmembers;               /* Number of them */
+    Member *next;               /* Space the next list of them is built in */
+    unsigned long long listed;  /* Time (in ns) they were last listed at */
+};
+
+
+/*
+ * Local method to open /proc/<pid>/<file>. Returns the descriptor, or -1.
+ */
+static int open_proc(pid_t pid, char *file) {
+
+    char path[64], pid_str[32];
+
+    p1itoa((int)pid, pid_str);
+    p1strcpy(path, "/proc/");
+    p1strcat(path, pid_str);
+    p1strcat(path, "/");
+    p1strcat(path, file);
+
+    return open(path, O_RDONLY | O_CLOEXEC);
+}
+
+/*
+ * Local method to open /proc/<pid>/task/<pid>/children, the children of the
+ * main thread of the process. Returns the descriptor, or -1.
+ */
+static int open_children(pid_t pid) {
+
+    char task[64], pid_str[32];
+
+    p1itoa((int)pid, pid_str);
+    p1strcpy(task, "task/");
+    p1strcat(task, pid_str);
+    p1strcat(task, "/children");
+
+    return open_proc(pid, task);
+}
+
+/*
+ * Local method to read the whole file into 'buf' with one pread() from its start;
+ * the contents are ended with '\0'. Returns the number of bytes read, or -1.
+ */
+static int read_proc(int fd, char *buf, int size) {
+
+    int n = pread(fd, buf, size - 1, 0);
+
+    if (n >= 0)
+        buf[n] = '\0';
+
+    return n;
+}
+
+/*
+ * Local method to skip to the next number at or after '*s', parse it, and leave
+ * '*s' just after it. Signs are skipped; the fields read here are never negative.
+ */
+static unsigned long scan_ulong(char **s) {
+
+    unsigned long n = 0L;
+    char *p = *s;
+
+    while (*p != '\0' && (*p < '0' || *p > '9'))
+        p++;
+    while (*p >= '0' && *p <= '9')
+        n = n * 10 + (*p++ - '0');
+    *s = p;
+
+    return n;
+}
+
+/*
+ * Local method to skip the next 'n' space separated fields at '*s'.
+ */
+static void skip_fields(char **s, int n) {
+
+    char *p = *s;
+
+    while (n-- > 0) {
+        while (*p == ' ')
+            p++;
+        while (*p != ' ' && *p != '\0')
+            p++;
+    }
+    *s = p;
+}
+
+/*
+ * Local method to find the fields after the command name in the contents of a
+ * /proc/<pid>/stat file of length 'n', which may hold spaces or ')'. Ends the
+ * command name, and stores where it starts into '*comm'. Returns a pointer to
+ * field 3, or NULL if the contents are not as expected.
+ */
+static char *stat_fields(char *buffer, int n, char **comm) {
+
+    char *p;
+    int i;
+
+    /* Start after the last ')' */
+    for (p = buffer + n - 1; p > buffer && *p != ')'; p--)
+        ;
+    if (*p != ')' || p[1] == '\0' || (i = p1strchr(buffer, '(')) < 0 || buffer + i >= p)
+        return NULL;
+    *p = '\0';
+    *comm = buffer + i + 1;
+
+    return p + 2;
+}
+
+/*
+ * Local method to parse fields 3 on of a /proc/<pid>/stat file into '*st'.
+ */
+static void parse_stat(char *p, ProcStat *st) {
+
+    /* Field 3 */
+    st->state = *p++;
+    /* Fields 4-11 are skipped, field 12 */
+    skip_fields(&p, 8);
+    st->majflt = scan_ulong(&p);
+    /* Field 13 is skipped, fields 14-17 */
+    skip_fields(&p, 1);
+    st->utime = scan_ulong(&p);
+    st->stime = scan_ulong(&p);
+    st->cutime = scan_ulong(&p);
+    st->cstime = scan_ulong(&p);
+    /* Fields 18-19 are skipped, field 20 */
+    skip_fields(&p, 2);
+    st->threads = scan_ulong(&p);
+    /* Fields 21-22 are skipped, fields 23-24 */
+    skip_fields(&p, 2);
+    st->vsize = scan_ulong(&p);
+    st->rss = scan_ulong(&p);
+}
+
+/*
+ * Local method to parse the contents of a /proc/<pid>/io file into '*io'.
+ */
+static void parse_io(char *p, ProcIO *io) {
+
+    /* One 'name: value' line per field, always in this order */
+    io->rchar = scan_ulong(&p);
+    io->wchar = scan_ulong(&p);
+    io->syscr = scan_ulong(&p);
+    io->syscw = scan_ulong(&p);
+    io->read_bytes = scan_ulong(&p);
+    io->write_bytes = scan_ulong(&p);
+}
+
+/*
+ * Local method to return the CPU time (in ns) of one process, given fields 3 on
+ * of its /proc/<pid>/stat, and the contents of its /proc/<pid>/schedstat, empty
+ * if it could not be read. See sm_cputime().
+ */
+static unsigned long long cputime(char *fields, char *sched) {
+
+    ProcStat st;
+    unsigned long long tick = 1000000000ULL / sysconf(_SC_CLK_TCK), ran;
+    char *p = sched;
+
+    parse_stat(fields, &st);
+    /* The first field of schedstat is the time run on a CPU */
+    if (st.threads == 1L && *p != '\0')
+        ran = scan_ulong(&p);
+    else
+        ran = (st.utime + st.stime) * tick;
+
+    return ran + (st.cutime + st.cstime) * tick;
+}
+
+/*
+ * Local method to return the current CLOCK_MONOTONIC time in ns.
+ */
+static unsigned long long now(void) {
+
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Local method to add the process with the given PID to the next list of the
+ * sampler's job, keeping its files open from the last list if it was there, or
+ * opening them if not. Returns the member, or NULL if it is already listed, the
+ * list is full, or the process is gone.
+ */
+static Member *add_member(Sampler *sm, int n, pid_t pid) {
+
+    Member *mb = sm->next + n;
+    int i;
+
+    if (pid == sm->pid || n >= MAX_MEMBERS)
+        return NULL;
+    for (i = 0; i < n; i++)
+        if (sm->next[i].pid == pid)
+            return NULL;
+
+    for (i = 0; i < sm->nmembers; i++) {
+        if (sm->members[i].pid == pid) {
+            /* Take its files over, so that they are not closed with the old list */
+            *mb = sm->members[i];
+            sm->members[i].pid = 0;
+            return mb;
+        }
+    }
+
+    mb->pid = pid;
+    if ((mb->stat_fd = open_proc(pid, "stat")) == -1)
+        return NULL;
+    mb->io_fd = open_proc(pid, "io");
+    mb->sched_fd = open_proc(pid, "schedstat");
+    mb->children_fd = -1;
+
+    return mb;
+}
+
+/*
+ * Local method to close the files of a member.
+ */
+static void close_member(Member *mb) {
+
+    close(mb->stat_fd);
+    if (mb->io_fd != -1)
+        close(mb->io_fd);
+    if (mb->sched_fd != -1)
+        close(mb->sched_fd);
+    if (mb->children_fd != -1)
+        close(mb->children_fd);
+}
+
+/*
+ * Local method to add the children listed in a children file to the next list
+ * of the sampler's job, after the 'n' already there. Returns the new length.
+ */
+static int add_children(Sampler *sm, int n, int fd) {
+
+    char buffer[PROCS_SIZE];
+    Member *mb;
+    pid_t pid;
+    char *p;
+
+    /* One PID per word */
+    if (fd == -1 || read_proc(fd, buffer, sizeof(buffer)) <= 0)
+        return n;
+    for (p = buffer; n < MAX_MEMBERS && (pid = (pid_t)scan_ulong(&p)) > 0; )
+        if ((mb = add_member(sm, n, pid)) != NULL)
+            n++;
+
+    return n;
+}
+
+/*
+ * Local method to list the other processes of the sampler's job, from its
+ * cgroup.procs file, or else from the children files of its leader and of each
+ * process found under it in turn, or else from the process group field (5) of
+ * every /proc/<pid>/stat. Keeps the last list until MEMBERS_PERIOD ms have
+ * passed, unless 'force' is set.
+ */
+static void list_members(Sampler *sm, int force) {
+
+    char buffer[BUFFER_SIZE];
+    struct dirent *entry;
+    Member *mb;
+    DIR *dir;
+    char *p, *comm;
+    pid_t pid;
+    int i, fd, n = 0;
+
+    if (!force && sm->listed != 0ULL && now() - sm->listed < MEMBERS_PERIOD * 1000000ULL)
+        return;
+    sm->listed = now();
+
+    if (sm->procs_fd != -1) {
+        /* One PID per line */
+        n = add_children(sm, 0, sm->procs_fd);
+    } else if (sm->children_fd != -1) {
+        /* Breadth first, the list itself is the queue */
+        n = add_children(sm, 0, sm->children_fd);
+        for (i = 0; i < n; i++) {
+            mb = sm->next + i;
+            if (mb->children_fd == -1)
+                mb->children_fd = open_children(mb->pid);
+            n = add_children(sm, n, mb->children_fd);
+        }
+    } else if ((dir = opendir("/proc")) != NULL) {
+        while (n < MAX_MEMBERS && (entry = readdir(dir)) != NULL) {
+            if (entry->d_name[0] < '1' || entry->d_name[0] > '9')
+                continue;
+            if ((pid = (pid_t)p1atoi(entry->d_name)) == sm->pid)
+                continue;
+            if ((fd = open_proc(pid, "stat")) == -1)
+                continue;
+            i = read_proc(fd, buffer, sizeof(buffer));
+            close(fd);
+            if (i <= 0 || (p = stat_fields(buffer, i, &comm)) == NULL)
+                continue;
+            /* Fields 3-4 are skipped, field 5 */
+            skip_fields(&p, 2);
+            if ((pid_t)scan_ulong(&p) == sm->pid && add_member(sm, n, pid) != NULL)
+                n++;
+        }
+        closedir(dir);
+    }
+
+    /* Close the files of those no longer listed, then swap the lists */
+    for (i = 0; i < sm->nmembers; i++)
+        if (sm->members[i].pid != 0)
+            close_member(sm->members + i);
+    mb = sm->members;
+    sm->members = sm->next;
+    sm->next = mb;
+    sm->nmembers = n;
+}
+
+Sampler *sm_open(pid_t pid) {
+
+    /* Allocate memory, open the files */
+    Sampler *sm = (Sampler *)malloc(sizeof(Sampler));
+    if (sm != NULL) {
+        sm->pid = pid;
+        sm->cmdline = NULL;
+        sm->comm[0] = '\0';
+        sm->job = 0;
+        sm->procs_fd = -1;
+        sm->children_fd = -1;
+        sm->members = NULL;
+        sm->nmembers = 0;
+        sm->next = NULL;
+        sm->listed = 0ULL;
+        if ((sm->stat_fd = open_proc(pid, "stat")) != -1) {
+            /* Reading I/O may be denied, the rest still works without it */
+            sm->io_fd = open_proc(pid, "io");
+            /* Only there with CONFIG_SCHED_INFO, clock ticks are used without it */
+            sm->sched_fd = open_proc(pid, "schedstat");
+        } else {
+            /* Open failed, free the struct */
+            free(sm);
+            sm = NULL;
+        }
+    }
+
+    return sm;
+}
+
+Sampler *sm_open_job(pid_t pid, char *procs) {
+
+    Sampler *sm = sm_open(pid);
+
+    if (sm != NULL) {
+        sm->job = 1;
+        sm->members = (Member *)malloc(MAX_MEMBERS * sizeof(Member));
+        sm->next = (Member *)malloc(MAX_MEMBERS * sizeof(Member));
+        if (sm->members == NULL || sm->next == NULL ||
+                (procs != NULL && (sm->procs_fd = open(procs, O_RDONLY | O_CLOEXEC)) == -1)) {
+            /* Allocation or open failed, close the rest */
+            sm_close(sm);
+            sm = NULL;
+        } else if (procs == NULL) {
+            /* Missing without CONFIG_PROC_CHILDREN, the process group is scanned then */
+            sm->children_fd = open_children(pid);
+        }
+    }
+
+    return sm;
+}
+
+int sm_stat(Sampler *sm, ProcStat *st) {
+
+    char buffer[BUFFER_SIZE];
+    char *p, *comm;
+    ProcStat other;
+    int i, n;
+
+    if ((n = read_proc(sm->stat_fd, buffer, sizeof(buffer))) <= 0 ||
+            (p = stat_fields(buffer, n, &comm)) == NULL)
+        return 0;
+
+    /* A new command name means the process exec()ed, drop the cached command line */
+    for (i = 0; comm[i] != '\0' && comm[i] == sm->comm[i]; i++)
+        ;
+    if (comm[i] != sm->comm[i]) {
+        for (i = 0; comm[i] != '\0' && i < (int)sizeof(sm->comm) - 1; i++)
+            sm->comm[i] = comm[i];
+        sm->comm[i] = '\0';
+        free(sm->cmdline);
+        sm->cmdline = NULL;
+    }
+    parse_stat(p, st);
+    if (!sm->job)
+        return 1;
+
+    /* Add in the rest of the job, listed again now if the leader waits on it */
+    list_members(sm, st->state == 'S');
+    for (i = 0; i < sm->nmembers; i++) {
+        if ((n = read_proc(sm->members[i].stat_fd, buffer, sizeof(buffer))) <= 0 ||
+                (p = stat_fields(buffer, n, &comm)) == NULL)
+            continue;
+        parse_stat(p, &other);
+        if (other.state == 'R' || (other.state == 'D' && st->state == 'S'))
+            st->state = other.state;
+        st->majflt += other.majflt;
+        st->utime += other.utime;
+        st->stime += other.stime;
+        st->cutime += other.cutime;
+        st->cstime += other.cstime;
+        st->threads += other.threads;
+        st->vsize += other.vsize;
+        st->rss += other.rss;
+    }
+
+    return 1;
+}
+
+int sm_io(Sampler *sm, ProcIO *io) {
+
+    char buffer[BUFFER_SIZE];
+    ProcIO other;
+    int i;
+
+    if (sm->io_fd == -1 || read_proc(sm->io_fd, buffer, sizeof(buffer)) <= 0)
+        return 0;
+    parse_io(buffer, io);
+    if (!sm->job)
+        return 1;
+
+    /* Add in the rest of the job */
+    list_members(sm, 0);
+    for (i = 0; i < sm->nmembers; i++) {
+        if (sm->members[i].io_fd == -1 ||
+                read_proc(sm->members[i].io_fd, buffer, sizeof(buffer)) <= 0)
+            continue;
+        parse_io(buffer, &other);
+        io->rchar += other.rchar;
+        io->wchar += other.wchar;
+        io->syscr += other.syscr;
+        io->syscw += other.syscw;
+        io->read_bytes += other.read_bytes;
+        io->write_bytes += other.write_bytes;
+    }
+
+    return 1;
+}
+
+char *sm_cmdline(Sampler *sm) {
+
+    char buffer[CMDLINE_SIZE];
+    int i, n, fd;
+
+    if (sm->cmdline != NULL)
+        return sm->cmdline;
+
+    /* Read once; it does not change after exec() */
+    if ((fd = open_proc(sm->pid, "cmdline")) == -1)
+        return "";
+    n = read_proc(fd, buffer, sizeof(buffer));
+    close(fd);
+    if (n <= 0)
+        return "";
+
+    /* Arguments are separated by '\0', replace them with spaces */
+    while (n > 0 && buffer[n - 1] == '\0')
+        n--;
+    for (i = 0; i < n; i++)
+        if (buffer[i] == '\0')
+            buffer[i] = ' ';
+    buffer[n] = '\0';
+
+    if ((sm->cmdline = p1strdup(buffer)) == NULL)
+        return "";
+
+    return sm->cmdline;
+}
+
+void sm_close(Sampler *sm) {
+
+    int i;
+
+    if (sm != NULL) {
+        close(sm->stat_fd);
+        if (sm->io_fd != -1)
+            close(sm->io_fd);
+        if (sm->procs_fd != -1)
+            close(sm->procs_fd);
+        if (sm->sched_fd != -1)
+            close(sm->sched_fd);
+        if (sm->children_fd != -1)
+            close(sm->children_fd);
+        for (i = 0; i < sm->nmembers; i++)
+            close_member(sm->members + i);
+        free(sm->members);
+        free(sm->next);
+        free(sm->cmdline);
+        free(sm);
+    }
+}
+
+int sm_cputime(Sampler *sm, unsigned long long *ns) {
+
+    char buffer[BUFFER_SIZE], sched[BUFFER_SIZE];
+    char *p, *comm, state;
+    Member *mb;
+    int i, n;
+
+    if ((n = read_proc(sm->stat_fd, buffer, sizeof(buffer))) <= 0 ||
+            (p = stat_fields(buffer, n, &comm)) == NULL)
+        return 0;
+    if (sm->sched_fd == -1 || read_proc(sm->sched_fd, sched, sizeof(sched)) <= 0)
+        sched[0] = '\0';
+    /* Field 3 is the state, see sm_stat() */
+    state = *p;
+    *ns = cputime(p, sched);
+    if (!sm->job)
+        return 1;
+
+    /* Add in the rest of the job */
+    list_members(sm, state == 'S');
+    for (i = 0; i < sm->nmembers; i++) {
+        mb = sm->members + i;
+        if ((n = read_proc(mb->stat_fd, buffer, sizeof(buffer))) <= 0 ||
+                (p = stat_fields(buffer, n, &comm)) == NULL)
+            continue;
+        if (mb->sched_fd == -1 || read_proc(mb->sched_fd, sched, sizeof(sched)) <= 0)
+            sched[0] = '\0';
+        *ns += cputime(p, sched);
+    }
+
+    return 1;
+}
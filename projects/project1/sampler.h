@@ -0,0 +1,122 @@
+/*
+ * sampler.h
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Header file for the /proc sampler ADT implementation. A sampler keeps the
+ * /proc files of one process open, so that each sample costs a single pread()
+ * per file instead of an open(), many read()s, and a close().
+ *
+ * A sampler may also cover the whole job a process leads, summing the counters
+ * of every process in it, so that programs which fork (shell scripts, build
+ * tools, ...) are accounted for in full.
+ *
+ * This is my own work.
+ */
+
+#ifndef _SAMPLER_H__
+#define _SAMPLER_H__
+
+#include <unistd.h>     /* Used for pid_t type */
+
+
+/*
+ * Data structure holding the open /proc files of a process.
+ */
+typedef struct sampler Sampler;
+
+/*
+ * Fields of /proc/<pid>/stat. Times are in clock ticks, sizes in bytes except
+ * for 'rss', which is in pages.
+ */
+typedef struct proc_stat {
+    char state;                 /* R, S, D, T, Z, ... */
+    unsigned long majflt;       /* Major faults */
+    unsigned long utime;        /* Time spent in user mode */
+    unsigned long stime;        /* Time spent in kernel mode */
+    unsigned long cutime;       /* Time waited-for children spent in user mode */
+    unsigned long cstime;       /* Time waited-for children spent in kernel mode */
+    unsigned long threads;      /* Number of threads */
+    unsigned long vsize;        /* Virtual memory size */
+    unsigned long rss;          /* Resident set size */
+} ProcStat;
+
+/*
+ * Fields of /proc/<pid>/io.
+ */
+typedef struct proc_io {
+    unsigned long rchar;        /* Bytes read */
+    unsigned long wchar;        /* Bytes written */
+    unsigned long syscr;        /* Read system calls */
+    unsigned long syscw;        /* Write system calls */
+    unsigned long read_bytes;   /* Bytes fetched from storage */
+    unsigned long write_bytes;  /* Bytes sent to storage */
+} ProcIO;
+
+
+/*
+ * Opens the /proc files of the process with the given PID. The files are
+ * closed on exec, so that children do not inherit them. Returns pointer to
+ * new instance, or NULL if the files could not be opened or allocation failed.
+ */
+Sampler *sm_open(pid_t pid);
+
+/*
+ * Opens the /proc files of the process with the given PID, like sm_open(), and
+ * makes sm_stat() and sm_io() cover every process of its job as well. The job is
+ * made up of the processes listed in 'procs', the cgroup.procs file of its cgroup,
+ * if not NULL; otherwise of the descendants of 'pid', or of the processes in the
+ * process group it leads where /proc does not list children. The list is
+ * refreshed every MEMBERS_PERIOD ms, and at once whenever the process is seen
+ * sleeping, as when it waits on a child it just forked. The files of the other
+ * processes are kept open as well, for as long as they are listed. Returns
+ * pointer to new instance, or NULL if the files could not be opened or
+ * allocation failed.
+ */
+Sampler *sm_open_job(pid_t pid, char *procs);
+
+/*
+ * Reads /proc/<pid>/stat, stores its fields into '*st'. For a job, the counts
+ * and sizes are summed over every process in it, and the state is that of the
+ * process unless another in the job is running ('R'), or waiting on I/O ('D')
+ * while the process sleeps.
+ *
+ * Returns 1 if successful, 0 if not (the process is gone).
+ */
+int sm_stat(Sampler *sm, ProcStat *st);
+
+/*
+ * Reads /proc/<pid>/io, stores its fields into '*io'. For a job, they are summed
+ * over every process in it whose file may be read.
+ *
+ * Returns 1 if successful, 0 if not (the process is gone, or the file may not
+ * be read).
+ */
+int sm_io(Sampler *sm, ProcIO *io);
+
+/*
+ * Returns the command line of the process, with its arguments separated by
+ * spaces. It is read on the first call and cached, until sm_stat() sees that
+ * the process has exec()ed another program. Returns an empty string on failure.
+ */
+char *sm_cmdline(Sampler *sm);
+
+/*
+ * Closes the files and destroys the sampler.
+ */
+void sm_close(Sampler *sm);
+
+/*
+ * Stores the CPU time (in ns) the process has used so far into '*ns', summed
+ * over its job for a job. The time a process ran is read from the scheduler's
+ * own nanosecond count in /proc/<pid>/schedstat, which only covers the main
+ * thread; for a process with several threads, or without the file, the clock
+ * ticks of /proc/<pid>/stat are used instead. Children that were waited for are
+ * only known in clock ticks.
+ *
+ * Returns 1 if successful, 0 if not (the process is gone).
+ */
+int sm_cputime(Sampler *sm, unsigned long long *ns);
+
+
+#endif/* _SAMPLER_H__ */
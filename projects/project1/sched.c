@@ -0,0 +1,47 @@
+/*
+ * sched.c
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Source file for the scheduling policy interface. Contains the registry of
+ * policies selectable with --policy=, and helpers shared by the policies.
+ *
+ * This is my own work.
+ */
+
+#include <stdlib.h>     /* Used for NULL */
+#include <time.h>       /* Used for clock_gettime() */
+#include "p1fxns.h"     /* Used for p1strlen(), p1strneq() */
+#include "sched.h"      /* Scheduling policy interface */
+
+
+/* Every policy that can be selected; add new policies here */
+static Policy *policies[] = {
+    &rr_policy,
+    &adaptive_policy,
+    &mlfq_policy,
+    &cfs_policy,
+    &edf_policy,
+    &sjf_policy,
+    NULL
+};
+
+
+Policy *sched_find(char *name) {
+
+    int i;
+
+    for (i = 0; policies[i] != NULL; i++)
+        if (p1strneq(name, policies[i]->name, p1strlen(policies[i]->name) + 1))
+            return policies[i];
+
+    return NULL;
+}
+
+unsigned long long sched_now(void) {
+
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
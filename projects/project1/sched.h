@@ -0,0 +1,127 @@
+/*
+ * sched.h
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Header file for the scheduling policy interface. A policy decides the order
+ * in which the processes waiting on a lane are run, and what happens to the
+ * running process when its quantum expires. The scheduler core (USPS v5) owns
+ * the processes, signals, and timers; it only calls into the policy through the
+ * functions below, so that policies can be swapped with --policy=.
+ *
+ * This is my own work.
+ */
+
+#ifndef _SCHED_H__
+#define _SCHED_H__
+
+#include "process.h"    /* Process ADT */
+
+/* Marks parameters a policy does not need */
+#define UNUSED __attribute__((unused))
+
+
+/*
+ * Settings shared by every lane, filled in by the scheduler before any lane is
+ * created. Policies keep a pointer to it, and must not change it.
+ */
+typedef struct sched_conf {
+    int quantum;                /* Time quantum (in us) */
+    int slice;                  /* Length of one quantum tick (in us) */
+    unsigned long long epoch;   /* Time (in ns) the workload was started at */
+} SchedConf;
+
+/*
+ * Table of functions implementing a scheduling policy. Each lane holds its own
+ * instance of the policy's queue, created with create() and passed back as 'q'.
+ * Functions marked optional may be NULL.
+ */
+typedef struct policy {
+    char *name;                 /* Name given to --policy= */
+    int sample_cpu;             /* 1 if on_tick() needs the process's CPU usage polled */
+
+    /*
+     * Creates the queue for one lane. Returns pointer to new instance, or NULL
+     * if allocation failed.
+     */
+    void *(*create)(SchedConf *conf);
+
+    /*
+     * Prepares a process that was just forked, before it is first queued;
+     * sets up its quantum ticks and any state the policy keeps in it.
+     */
+    void (*admit)(void *q, Process *pr);
+
+    /*
+     * Queues a process to wait for the lane. Returns 1 if successful, 0 if not
+     * (allocation failed).
+     */
+    int (*enqueue)(void *q, Process *pr);
+
+    /*
+     * Takes the next process to run off the queue, stores it into '*pr'.
+     * Returns 1 if successful, 0 if the queue is empty.
+     */
+    int (*pick_next)(void *q, Process **pr);
+
+    /*
+     * Returns the number of processes waiting on the queue.
+     */
+    long (*size)(void *q);
+
+    /*
+     * Invoked when the quantum of the running process 'pr' expires, before it
+     * is preempted. May change its quantum ticks for the next run. Returns 1 if
+     * it should keep running even though other processes are waiting, 0 if it
+     * should be put back on a queue.
+     */
+    int (*on_tick)(void *q, Process *pr);
+
+    /*
+     * Optional. Invoked when the running process 'pr' blocks before its quantum
+     * expires, and gives up the lane.
+     */
+    void (*on_block)(void *q, Process *pr);
+
+    /*
+     * Optional. Invoked when a process of the lane has finished, before it is
+     * freed.
+     */
+    void (*on_exit)(void *q, Process *pr);
+
+    /*
+     * Destroys the queue. Applies 'freeFxn' to each process still waiting on
+     * it, if not NULL.
+     */
+    void (*destroy)(void *q, void (*freeFxn)(void *));
+} Policy;
+
+
+/* The policies available, see policy_*.c */
+extern Policy rr_policy;
+extern Policy adaptive_policy;
+extern Policy mlfq_policy;
+extern Policy cfs_policy;
+extern Policy edf_policy;
+extern Policy sjf_policy;
+
+/*
+ * Orders two processes by '@deadline=', earliest first, then by PID to break
+ * ties; since PIDs are handed out in workload order, processes without a
+ * deadline sort after the rest, in that order. Defined by the EDF policy, and
+ * shared with the deadline admission test of USPS v5.
+ */
+int edf_compare(void *a, void *b);
+
+/*
+ * Returns the policy registered under 'name', NULL if there is none.
+ */
+Policy *sched_find(char *name);
+
+/*
+ * Returns the current time of the monotonic clock, in nanoseconds.
+ */
+unsigned long long sched_now(void);
+
+
+#endif/* _SCHED_H__ */
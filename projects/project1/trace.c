@@ -0,0 +1,105 @@
+/*
+ * trace.c
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Source file for the Trace ADT implementation. Events are kept in an array
+ * used as a ring: 'next' counts every event ever recorded, and is masked into
+ * the array, whose length is a power of 2. Recording an event costs one
+ * clock_gettime() and a few stores, so that tracing barely disturbs the
+ * scheduling it measures.
+ *
+ * This is my own work.
+ */
+
+#include <stdlib.h>     /* Used for malloc(), free(), NULL */
+#include <string.h>     /* Used for memcpy(), memset() */
+#include <time.h>       /* Used for clock_gettime(), CLOCK_MONOTONIC */
+#include "p1fxns.h"     /* Used for P1Writer */
+#include "trace.h"      /* Trace ADT */
+
+/* Smallest number of events allocated */
+#define MIN_EVENTS 1024L
+
+
+/*
+ * Struct that represents the trace itself
+ */
+struct trace {
+    TraceEvent *events;         /* Array of events */
+    unsigned long mask;         /* Number of events minus one */
+    unsigned long next;         /* Number of events ever recorded */
+};
+
+
+Trace *tr_create(long capacity) {
+
+    Trace *tr;
+    long nevents = MIN_EVENTS;
+
+    while (nevents < capacity)
+        nevents *= 2;
+
+    /* Allocate memory, initialize the members */
+    if ((tr = (Trace *)malloc(sizeof(Trace))) != NULL) {
+        if ((tr->events = (TraceEvent *)malloc(nevents * sizeof(TraceEvent))) != NULL) {
+            tr->mask = (unsigned long)(nevents - 1);
+            tr->next = 0UL;
+        } else {
+            /* Allocation failed, free the struct */
+            free(tr);
+            tr = NULL;
+        }
+    }
+
+    return tr;
+}
+
+void tr_record(Trace *tr, TraceType type, pid_t pid, int lane, int ticks) {
+
+    struct timespec ts;
+    TraceEvent *ev = &tr->events[tr->next++ & tr->mask];
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ev->time = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    ev->pid = (int32_t)pid;
+    ev->type = (uint8_t)type;
+    ev->lane = (lane >= 0 && lane < TRACE_NOLANE) ? (uint8_t)lane : TRACE_NOLANE;
+    ev->ticks = (ticks >= 0 && ticks <= 0xFFFF) ? (uint16_t)ticks : 0xFFFF;
+}
+
+int tr_dump(Trace *tr, int fd, int slice) {
+
+    TraceHeader header;
+    P1Writer *out;
+    unsigned long i, first;
+    int ok;
+
+    if ((out = p1wopen(fd)) == NULL)
+        return 0;
+
+    /* Once the ring wrapped, the oldest event left sits right after the newest */
+    first = (tr->next > tr->mask + 1) ? tr->next - (tr->mask + 1) : 0UL;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.size = sizeof(TraceEvent);
+    header.slice = (uint32_t)slice;
+    header.count = tr->next - first;
+    header.lost = first;
+
+    ok = (p1wwrite(out, &header, sizeof(header)) != -1);
+    for (i = first; ok && i < tr->next; i++)
+        ok = (p1wwrite(out, &tr->events[i & tr->mask], sizeof(TraceEvent)) != -1);
+    ok = (p1wflush(out) == 0 && ok);
+    p1wclose(out);
+
+    return ok;
+}
+
+void tr_destroy(Trace *tr) {
+
+    if (tr != NULL) {
+        free(tr->events);
+        free(tr);
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ * trace.h
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Header file for the Trace ADT implementation, an in-memory log of scheduler
+ * events stamped with CLOCK_MONOTONIC nanoseconds, and the layout of the trace
+ * file it is dumped to. A trace file is one TraceHeader followed by the events
+ * in the order they were recorded, all in the byte order of the machine that
+ * wrote them; see uspstrace.c for a program that analyzes it.
+ *
+ * This is my own work.
+ */
+
+#ifndef _TRACE_H__
+#define _TRACE_H__
+
+#include <stdint.h>     /* Used for uint8_t, uint16_t, uint32_t, uint64_t */
+#include <unistd.h>     /* Used for pid_t type */
+
+/* First bytes of every trace file */
+#define TRACE_MAGIC "USPSTRC2"
+/* Lane of events that do not happen on a lane */
+#define TRACE_NOLANE 0xFF
+
+
+/*
+ * Data structure for a bounded log of events; once full, each new event
+ * replaces the oldest.
+ */
+typedef struct trace Trace;
+
+/*
+ * Kinds of events recorded. A process is runnable from T_ADMIT, T_STOP and
+ * T_WAKE until its next T_DISPATCH; it holds a lane from T_DISPATCH until
+ * T_STOP, T_BLOCK, or T_EXIT.
+ */
+typedef enum {
+    T_ADMIT,            /* Forked and queued */
+    T_DISPATCH,         /* Started or resumed */
+    T_CONTINUE,         /* Quantum expired, but it keeps the lane */
+    T_STOP,             /* Quantum expired, stopped and queued again */
+    T_BLOCK,            /* Gave up the lane to sleep or wait on I/O */
+    T_WAKE,             /* Runnable again after blocking, queued */
+    T_EXIT,             /* Reaped */
+    T_QUANTUM           /* Quantum changed by the policy */
+} TraceType;
+
+/*
+ * Written once, at the start of a trace file.
+ */
+typedef struct trace_header {
+    char magic[8];              /* TRACE_MAGIC, not '\0' terminated */
+    uint32_t size;              /* Size of one TraceEvent, in bytes */
+    uint32_t slice;             /* Length of one quantum tick (in us) */
+    uint64_t count;             /* Number of events that follow */
+    uint64_t lost;              /* Number of older events replaced before the dump */
+} TraceHeader;
+
+/*
+ * One recorded event.
+ */
+typedef struct trace_event {
+    uint64_t time;              /* CLOCK_MONOTONIC time (in ns) */
+    int32_t pid;                /* PID of the process */
+    uint8_t type;               /* A TraceType */
+    uint8_t lane;               /* Lane it happened on, or TRACE_NOLANE */
+    uint16_t ticks;             /* Quantum of the process (in ticks) at the time */
+} TraceEvent;
+
+
+/*
+ * Creates a new, empty trace with room for 'capacity' events. Returns pointer
+ * to new instance, or NULL if allocation failed.
+ */
+Trace *tr_create(long capacity);
+
+/*
+ * Records an event, stamped with the current time. Never allocates memory.
+ */
+void tr_record(Trace *tr, TraceType type, pid_t pid, int lane, int ticks);
+
+/*
+ * Writes the trace to 'fd' as a trace file, oldest event first; 'slice' is
+ * stored in the header.
+ *
+ * Returns 1 if successful, 0 if not (a write failed).
+ */
+int tr_dump(Trace *tr, int fd, int slice);
+
+/*
+ * Destroys the trace instance.
+ */
+void tr_destroy(Trace *tr);
+
+
+#endif/* _TRACE_H__ */
@@ -0,0 +1,357 @@
+/*
+ * uspstrace.c
+ * Author: Cole Vikupitz
+ * CIS 415 - Project 1
+ *
+ * Analyzes a trace file written by USPS v5 with --trace=<file> (see trace.h).
+ * The events are replayed in order, and the following are printed, each as a
+ * summary line and a histogram with power of 2 buckets (in microseconds):
+ *
+ *   Response time: from admission until the job first runs.
+ *   Wait time: the total time a job spent runnable but not running.
+ *   Turnaround: from admission until the job is reaped.
+ *   Slice jitter: how far each full slice strayed from the job's quantum.
+ *   Context switch: from a lane giving up a job until it runs the next one.
+ *
+ * This is my own work.
+ */
+
+#include <fcntl.h>      /* Used for open() */
+#include <stdlib.h>     /* Used for malloc(), calloc(), free(), NULL */
+#include <string.h>     /* Used for memcmp() */
+#include <sys/stat.h>   /* Used for fstat() */
+#include <unistd.h>     /* Used for read(), close() */
+#include "p1fxns.h"     /* Used for p1putstr(), p1strcpy(), p1strcat(), ... */
+#include "pidmap.h"     /* PidMap ADT */
+#include "trace.h"      /* Trace file layout */
+
+/* Number of histogram buckets; the last holds everything above the rest */
+#define NBUCKETS 32
+/* Width of the longest bar printed */
+#define BAR_WIDTH 40
+/* Number of lanes a trace may refer to */
+#define NLANES 256
+/* Usage message, printed after the program name */
+#define USAGE " <trace_file>"
+
+
+/*
+ * Distribution of a set of durations (in ns).
+ */
+typedef struct hist {
+    long count;                         /* Number of durations added */
+    unsigned long long sum;             /* Their sum */
+    unsigned long long min;             /* The shortest */
+    unsigned long long max;             /* The longest */
+    long buckets[NBUCKETS];             /* Counts by power of 2 microseconds */
+} Hist;
+
+/*
+ * What is known about one job while the trace is replayed.
+ */
+typedef struct job {
+    unsigned long long admitted;        /* Time it was admitted, 0 if not seen */
+    unsigned long long runnable;        /* Time it last became runnable, 0 if not runnable */
+    unsigned long long slice_start;     /* Time its current slice started, 0 if not running */
+    unsigned long long slice_len;       /* Length (in ns) its current slice should be */
+    unsigned long long waited;          /* Total time (in ns) spent runnable */
+    int dispatched;                     /* 1 once it has run */
+    int lane;                           /* Lane it last ran on */
+} Job;
+
+/* Histograms of each measure */
+static Hist response, wait, turnaround, jitter, cswitch;
+/* Time each lane was last given up, 0 if it has not been since it last dispatched */
+static unsigned long long lane_free[NLANES];
+/* Length (in ns) of one quantum tick */
+static unsigned long long slice_ns = 0ULL;
+
+/* Replays one event */
+static void replay(PidMap *jobs, TraceEvent *ev);
+/* Adds a duration to the histogram */
+static void hist_add(Hist *h, unsigned long long ns);
+/* Prints the histogram under the given title */
+static void hist_print(Hist *h, char *title);
+/* Formats an unsigned number into a string */
+static void p1ulltoa(unsigned long long n, char *buf);
+/* Prints the given message and exits the program */
+static void print_error(char *msg);
+
+
+/*
+ * Runs the program.
+ */
+int main(int argc, char **argv) {
+
+    struct stat sb;
+    TraceHeader header;
+    TraceEvent *events;
+    PidMap *jobs;
+    char buffer[4096], num[32];
+    unsigned long long i;
+    long n, got, r;
+    int fd;
+
+    if (argc != 2) {
+        p1strcpy(buffer, "Usage: ");
+        p1strcat(buffer, argv[0]);
+        p1strcat(buffer, USAGE);
+        print_error(buffer);
+    }
+
+    /* Read the header, check that it is a trace this program understands */
+    if ((fd = open(argv[1], O_RDONLY)) < 0) {
+        p1strcpy(buffer, "ERROR: Failed to open: ");
+        p1strcat(buffer, argv[1]);
+        print_error(buffer);
+    }
+    if (read(fd, &header, sizeof(header)) != sizeof(header) ||
+            memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0 ||
+            header.size != sizeof(TraceEvent) || fstat(fd, &sb) == -1 ||
+            (unsigned long long)sb.st_size != sizeof(header) + header.count * sizeof(TraceEvent)) {
+        close(fd);
+        p1strcpy(buffer, "ERROR: Not a complete USPS trace file: ");
+        p1strcat(buffer, argv[1]);
+        print_error(buffer);
+    }
+
+    /* Read the events in one go */
+    n = (long)(header.count * sizeof(TraceEvent));
+    if ((events = (TraceEvent *)malloc(n + 1)) == NULL) {
+        close(fd);
+        p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+        print_error(buffer);
+    }
+    for (got = 0L; got < n; got += r) {
+        if ((r = read(fd, (char *)events + got, n - got)) <= 0L) {
+            close(fd);
+            free(events);
+            p1strcpy(buffer, "ERROR: Failed to read: ");
+            p1strcat(buffer, argv[1]);
+            print_error(buffer);
+        }
+    }
+    close(fd);
+
+    /* Replay the events, keeping the state of each job by PID */
+    if ((jobs = pm_create(64L)) == NULL) {
+        free(events);
+        p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+        print_error(buffer);
+    }
+    slice_ns = header.slice * 1000ULL;
+    for (i = 0ULL; i < header.count; i++)
+        replay(jobs, &events[i]);
+
+    /* Print the results */
+    p1putstr(STDOUT_FILENO, "Trace: ");
+    p1ulltoa(header.count, num);
+    p1putstr(STDOUT_FILENO, num);
+    p1putstr(STDOUT_FILENO, " events, slice of ");
+    p1putint(STDOUT_FILENO, (int)header.slice);
+    p1putstr(STDOUT_FILENO, " us\n");
+    if (header.lost > 0ULL) {
+        p1putstr(STDOUT_FILENO, "Note: the oldest ");
+        p1ulltoa(header.lost, num);
+        p1putstr(STDOUT_FILENO, num);
+        p1putstr(STDOUT_FILENO, " events were overwritten; jobs admitted before that are left out.\n");
+    }
+    hist_print(&response, "Response time (admission to first run)");
+    hist_print(&wait, "Wait time (total time runnable, per job)");
+    hist_print(&turnaround, "Turnaround (admission to exit)");
+    hist_print(&jitter, "Slice jitter (|slice - quantum|)");
+    hist_print(&cswitch, "Context switch (lane given up to next dispatch)");
+
+    pm_destroy(jobs, free);
+    free(events);
+
+    return 0;
+}
+
+/*
+ * Replays one event: updates the state of the job it is about, and adds any
+ * duration it ends to its histogram. Events about jobs whose admission is not
+ * in the trace are skipped.
+ */
+static void replay(PidMap *jobs, TraceEvent *ev) {
+
+    Job *job = (Job *)pm_get(jobs, (pid_t)ev->pid);
+    unsigned long long t = ev->time;
+    char buffer[256];
+
+    if (ev->type == T_ADMIT) {
+        if (job == NULL) {
+            if ((job = (Job *)calloc(1, sizeof(Job))) == NULL || !pm_put(jobs, (pid_t)ev->pid, job)) {
+                p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+                print_error(buffer);
+            }
+        }
+        job->admitted = job->runnable = t;
+        return;
+    }
+    if (job == NULL)
+        return;
+
+    switch (ev->type) {
+        case T_DISPATCH:
+            /* Runnable until now; the lane was free since its last job left */
+            if (!job->dispatched)
+                hist_add(&response, t - job->admitted);
+            if (job->runnable != 0ULL)
+                job->waited += t - job->runnable;
+            if (lane_free[ev->lane] != 0ULL)
+                hist_add(&cswitch, t - lane_free[ev->lane]);
+            lane_free[ev->lane] = 0ULL;
+            job->dispatched = 1;
+            job->runnable = 0ULL;
+            job->lane = ev->lane;
+            job->slice_start = t;
+            job->slice_len = ev->ticks * slice_ns;
+            break;
+        case T_CONTINUE:
+        case T_STOP:
+            /* A full slice ended */
+            if (job->slice_start != 0ULL)
+                hist_add(&jitter, (t - job->slice_start > job->slice_len) ?
+                    t - job->slice_start - job->slice_len : job->slice_len - (t - job->slice_start));
+            if (ev->type == T_CONTINUE) {
+                job->slice_start = t;
+                job->slice_len = ev->ticks * slice_ns;
+            } else {
+                job->slice_start = 0ULL;
+                job->runnable = t;
+                lane_free[ev->lane] = t;
+            }
+            break;
+        case T_BLOCK:
+            job->slice_start = 0ULL;
+            lane_free[ev->lane] = t;
+            break;
+        case T_WAKE:
+            job->runnable = t;
+            break;
+        case T_EXIT:
+            /* If it held a lane, the lane is free from now */
+            if (job->slice_start != 0ULL)
+                lane_free[job->lane] = t;
+            if (job->runnable != 0ULL)
+                job->waited += t - job->runnable;
+            hist_add(&wait, job->waited);
+            hist_add(&turnaround, t - job->admitted);
+            free(pm_remove(jobs, (pid_t)ev->pid));
+            break;
+        case T_QUANTUM:
+        default:
+            break;
+    }
+}
+
+/*
+ * Adds the duration to the histogram, in the bucket of its power of 2 in
+ * microseconds.
+ */
+static void hist_add(Hist *h, unsigned long long ns) {
+
+    unsigned long long us = ns / 1000ULL;
+    int b;
+
+    for (b = 0; b < NBUCKETS - 1 && us >= (2ULL << b); b++)
+        ;
+    h->buckets[b]++;
+    if (h->count == 0L || ns < h->min)
+        h->min = ns;
+    if (ns > h->max)
+        h->max = ns;
+    h->sum += ns;
+    h->count++;
+}
+
+/*
+ * Prints the title, the count, minimum, mean and maximum (in microseconds), and
+ * a bar for each bucket from the first to the last that is not empty.
+ */
+static void hist_print(Hist *h, char *title) {
+
+    char line[256], num[32];
+    char *ptr;
+    long most = 0L;
+    int b, first = -1, last = 0, i, len;
+
+    p1putstr(STDOUT_FILENO, "\n");
+    p1putstr(STDOUT_FILENO, title);
+    p1putstr(STDOUT_FILENO, ":\n");
+    if (h->count == 0L) {
+        p1putstr(STDOUT_FILENO, "  (none)\n");
+        return;
+    }
+
+    p1strcpy(line, "  count ");
+    p1ulltoa((unsigned long long)h->count, num);
+    p1strcat(line, num);
+    p1strcat(line, ", min ");
+    p1ulltoa(h->min / 1000ULL, num);
+    p1strcat(line, num);
+    p1strcat(line, " us, mean ");
+    p1ulltoa(h->sum / h->count / 1000ULL, num);
+    p1strcat(line, num);
+    p1strcat(line, " us, max ");
+    p1ulltoa(h->max / 1000ULL, num);
+    p1strcat(line, num);
+    p1strcat(line, " us\n");
+    p1putstr(STDOUT_FILENO, line);
+
+    for (b = 0; b < NBUCKETS; b++) {
+        if (h->buckets[b] == 0L)
+            continue;
+        if (first == -1)
+            first = b;
+        last = b;
+        if (h->buckets[b] > most)
+            most = h->buckets[b];
+    }
+
+    for (b = first; b <= last; b++) {
+        /* Lower bound of the bucket, right aligned */
+        p1ulltoa((b == 0) ? 0ULL : (1ULL << b), num);
+        ptr = p1strpack(num, -12, ' ', line);
+        ptr = p1strpack(" us |", 0, ' ', ptr);
+        p1ulltoa((unsigned long long)h->buckets[b], num);
+        ptr = p1strpack(num, -8, ' ', ptr);
+        /* Bar scaled to the fullest bucket, at least one mark if not empty */
+        len = (int)((h->buckets[b] * BAR_WIDTH + most - 1) / most);
+        if (len > 0)
+            *ptr++ = ' ';
+        for (i = 0; i < len; i++)
+            *ptr++ = '#';
+        *ptr++ = '\n';
+        *ptr = '\0';
+        p1putstr(STDOUT_FILENO, line);
+    }
+}
+
+/*
+ * Converts the specified unsigned number into a string.
+ */
+static void p1ulltoa(unsigned long long n, char *buf) {
+
+    char tmp[32];
+    int i = 0;
+
+    do {
+        tmp[i++] = (char)('0' + n % 10ULL);
+        n /= 10ULL;
+    } while (n != 0ULL);
+    while (--i >= 0)
+        *buf++ = tmp[i];
+    *buf = '\0';
+}
+
+/*
+ * Prints out specified error message and exits program.
+ */
+static void print_error(char *msg) {
+
+    p1strcat(msg, "\n");
+    p1putstr(STDOUT_FILENO, msg);
+    _exit(1);
+}
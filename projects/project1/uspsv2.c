@@ -185,26 +185,36 @@ int main(int argc, char **argv) {
  */
 static void load_processes(int fd) {
 
+    P1Reader *rd;
     Process *pr;
     char buffer[4096], word[1024];
+    char *line;
     int len;
 
-    while (p1getline(fd, buffer, sizeof(buffer)) > 0) {
+    /* Read the file in blocks rather than a byte at a time */
+    if ((rd = p1ropen(fd)) == NULL) {
+        if (fd != STDIN_FILENO)
+            close(fd);
+        p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory");
+        print_error(buffer);
+    }
+
+    while ((line = p1rgetline(rd, &len)) != NULL) {
 
         /* Ignores blank lines */
-        p1getword(buffer, 0, word);
+        p1getword(line, 0, word);
         if (p1strneq(word, "\n", 1))
             continue;
         
         /* Trim off newline */
-        len = p1strlen(buffer);
-        if (buffer[len - 1] == '\n')
-            buffer[len - 1] = '\0';
+        if (line[len - 1] == '\n')
+            line[len - 1] = '\0';
 
         /* Creates the process from the given line */
-        pr = malloc_pr(buffer);
+        pr = malloc_pr(line);
         if (pr == NULL) {
             /* Allocation failed, print error and exit */
+            p1rclose(rd);
             if (fd != STDIN_FILENO)
                 close(fd);
             p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory");
@@ -214,6 +224,7 @@ static void load_processes(int fd) {
         /* Insert the new struct instance into list */
         if (!cl_insert(pr_list, pr)) {
             /* Insertion failed, print error and exit */
+            p1rclose(rd);
             if (fd != STDIN_FILENO)
                 close(fd);
             free_pr(pr);
@@ -223,6 +234,7 @@ static void load_processes(int fd) {
     }
 
     /* File no longer needed, close it */
+    p1rclose(rd);
     if (fd != STDIN_FILENO)
         close(fd);
 }
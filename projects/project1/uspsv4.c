@@ -76,6 +76,8 @@ static void p1ltoa(long number, char *buf);
 static void ticks_to_sec(char *ticks);
 /* Converts pages in string to total bytes */
 static void pages_to_bytes(char *buff);
+/* Reads a whole /proc file into a buffer, without allocating */
+static int read_proc(char *path, char *buf, int size);
 /* Prints out process information by accessing files in the proc directory */
 static void print(Process *pr);
 /* Frees the program's reserved memory */
@@ -281,26 +283,36 @@ int main(int argc, char **argv) {
  */
 static void load_processes(int fd) {
 
+    P1Reader *rd;
     Process *pr;
     char buffer[4096], word[1024];
+    char *line;
     int len;
 
-    while (p1getline(fd, buffer, sizeof(buffer)) > 0) {
+    /* Read the file in blocks rather than a byte at a time */
+    if ((rd = p1ropen(fd)) == NULL) {
+        if (fd != STDIN_FILENO)
+            close(fd);
+        p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory");
+        print_error(buffer);
+    }
+
+    while ((line = p1rgetline(rd, &len)) != NULL) {
 
         /* Ignores blank lines */
-        p1getword(buffer, 0, word);
+        p1getword(line, 0, word);
         if (p1strneq(word, "\n", 1))
             continue;
         
         /* Trim off newline */
-        len = p1strlen(buffer);
-        if (buffer[len - 1] == '\n')
-            buffer[len - 1] = '\0';
+        if (line[len - 1] == '\n')
+            line[len - 1] = '\0';
 
         /* Creates the process from the given line */
-        pr = malloc_pr(buffer);
+        pr = malloc_pr(line);
         if (pr == NULL) {
             /* Allocation failed, print error and exit */
+            p1rclose(rd);
             if (fd != STDIN_FILENO)
                 close(fd);
             p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory");
@@ -310,6 +322,7 @@ static void load_processes(int fd) {
         /* Insert the new struct instance into list */
         if (!cl_insert(pr_list, pr)) {
             /* Insertion failed, print error and exit */
+            p1rclose(rd);
             if (fd != STDIN_FILENO)
                 close(fd);
             free_pr(pr);
@@ -319,6 +332,7 @@ static void load_processes(int fd) {
     }
 
     /* File no longer needed, close it */
+    p1rclose(rd);
     if (fd != STDIN_FILENO)
         close(fd);
 }
@@ -577,6 +591,25 @@ static void pages_to_bytes(char *buff) {
     compact_size(buff);
 }
 
+/*
+ * Reads the whole of the /proc file at 'path' into 'buf' with a single read(),
+ * ending the contents with '\0'. print() runs inside the SIGALRM handler, so it
+ * may not allocate a P1Reader. Returns the number of bytes read, or -1.
+ */
+static int read_proc(char *path, char *buf, int size) {
+
+    int fd, n;
+
+    if ((fd = open(path, O_RDONLY)) < 0)
+        return -1;
+    n = read(fd, buf, size - 1);
+    close(fd);
+    if (n >= 0)
+        buf[n] = '\0';
+
+    return n;
+}
+
 /*
  * Prints out information on the specified process by accesssing its files
  * from within the /proc/<pid>/ directory.
@@ -585,23 +618,22 @@ static void pages_to_bytes(char *buff) {
 static void print(Process *pr) {
 
     static unsigned long iter = 0;
-    int i, index;
-    int cmd_fd = -1, io_fd = -1, stat_fd = -1;
+    int i, index, len;
     char pid_str[32], syscr[32], syscw[32], stat[32], flts[32],
         usrtm[32], systm[32], vmsz[32], rssz[32], cmd[2048];
     char res[4096], buffer[4096], word[1024];
-    char *res_ptr = NULL;
+    char *res_ptr = NULL, *line, *next;
 
     /* Access the /proc/<pid>/cmdline file */
     p1itoa((int)pr_pid(pr), pid_str);
     p1strcpy(buffer, "/proc/");
     p1strcat(buffer, pid_str);
     p1strcat(buffer, "/cmdline");
-    if ((cmd_fd = open(buffer, O_RDONLY)) < 0)
-        goto close_files;
 
-    /* Store the cmd into a buffer for later */
-    p1getline(cmd_fd, cmd, sizeof(cmd));
+    /* Store the cmd into a buffer for later, ended with two '\0's */
+    if ((len = read_proc(buffer, cmd, sizeof(cmd) - 1)) < 0)
+        return;
+    cmd[len + 1] = '\0';
     i = 0;
     while (1) {
         if (cmd[i] == '\0') {
@@ -613,50 +645,50 @@ static void print(Process *pr) {
         }
         i++;
     }
-    close(cmd_fd);
-    cmd_fd = -1;
 
     /* Accesses the /proc/<pid>/io file */
     p1strcpy(buffer, "/proc/");
     p1strcat(buffer, pid_str);
     p1strcat(buffer, "/io");
-    if ((io_fd = open(buffer, O_RDONLY)) < 0)
-        goto close_files;
-    i = 1;
+    if (read_proc(buffer, buffer, sizeof(buffer)) < 0)
+        return;
 
     /* Only want to extract the system read and write calls; need to skip some lines */
-    while (p1getline(io_fd, buffer, sizeof(buffer))) {
+    syscr[0] = syscw[0] = '\0';
+    for (i = 1, line = buffer; *line != '\0'; i++, line = next) {
+        /* End the line in place, find where the next one starts */
+        for (len = 0; line[len] != '\0' && line[len] != '\n'; len++)
+            ;
+        next = (line[len] == '\n') ? line + len + 1 : line + len;
+        line[len] = '\0';
         index = 0;
-        index = p1getword(buffer, index, word);
+        index = p1getword(line, index, word);
         if (i == 3) {
             /* On the 3rd line is the system read calls */
-            index = p1getword(buffer, index, syscr);
-            syscr[p1strlen(syscr)-1] = '\0';
+            index = p1getword(line, index, syscr);
             compact_num(syscr);
         }
         if (i == 4) {
             /* On the 4th line is the system write calls */
-            index = p1getword(buffer, index, syscw);
-            syscw[p1strlen(syscw)-1] = '\0';
+            index = p1getword(line, index, syscw);
             compact_num(syscw);
         }
-        i++;
     }
-    close(io_fd);
-    io_fd = -1;
 
     /* Accesses the /proc/<pid>/stat file */
     p1strcpy(buffer, "/proc/");
     p1strcat(buffer, pid_str);
     p1strcat(buffer, "/stat");
-    if ((stat_fd = open(buffer, O_RDONLY)) < 0)
-        goto close_files;
+    if ((len = read_proc(buffer, buffer, sizeof(buffer))) <= 0)
+        return;
 
     /* All information is on one line; need to extract by word */
-    p1getline(stat_fd, buffer, sizeof(buffer));
+    if (buffer[len - 1] == '\n')
+        buffer[len - 1] = '\0';
+    line = buffer;
     i = 1;
     index = 0;
-    while ((index = p1getword(buffer, index, word)) != -1) {
+    while ((index = p1getword(line, index, word)) != -1) {
         switch (i) {
             /* Obtains the current status of the process */
             case 3:
@@ -693,8 +725,6 @@ static void print(Process *pr) {
         }
         i++;
     }
-    close(stat_fd);
-    stat_fd = -1;
 
     /* Redisplay the header when needed */
     if (!iter)
@@ -719,17 +749,6 @@ static void print(Process *pr) {
     /* Prints out the process information */
     p1putstr(STDOUT_FILENO, res);
     p1putstr(STDOUT_FILENO, "\n");
-    return;
-
-close_files:
-    /* Close any open files and return */
-    if (cmd_fd != -1)
-        close(cmd_fd);
-    if (io_fd != -1)
-        close(io_fd);
-    if (stat_fd != -1)
-        close(stat_fd);
-    return;
 }
 
 /*
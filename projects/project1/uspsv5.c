@@ -1,76 +1,366 @@
+#define _GNU_SOURCE             /* Needed for CPU_SET(), sched_setaffinity() */
+
 /*
  * uspsv5.c
  * Author: Cole Vikupitz (cvikupit)
  * CIS 415 - Project 1
  *
- * A smarter version of v4, adjusts the time quantum for each process to help
- * run the work load more efficiently. CPU-bound processes will be given slightly
- * more ticks per time quantum, while I/O-bound processes will get slightly less.
- * Also added another column in the report that prints the CPU utilization percentage
- * (although not very accurate when running programs that fork more processes).
+ * The final version of the USPS. Runs the jobs of a workload file, time-slicing
+ * them on one or more CPUs under a choice of scheduling policies, and reports
+ * their CPU, memory and I/O usage as they run.
  *
  * This is my own work, with the exception of the functions used in p1fxns.c/h
  * provided by Joe Sventek. In addition, some code sections have been borrowed
  * from the LPE book as well, specifically sections 8.4.5-6 where the timer and
  * child handlers are implemented.
+ *
+ * Scheduling is driven by one epoll loop in main(): SIGCHLD is read from a
+ * signalfd, each lane ticks on a timerfd, and children are watched through
+ * pidfds where the kernel supports them. With --cpus=N, N lanes run at once,
+ * each pinned to a CPU, and an idle lane steals work from the busiest one. The
+ * policies live behind the interface in sched.h (adaptive, rr, mlfq, cfs, edf
+ * and sjf). A job that sleeps gives up the rest of its slice.
+ *
+ * Each job runs in a process group of its own, optionally in a cgroup that is
+ * frozen while it is stopped, and may be named and ordered after other jobs
+ * with '@name=' and '@after='. Jobs may also be admitted at run time through
+ * --fifo= or --socket=, bounded in number with --max-live=, held back under
+ * --mem-limit=, and have their output captured with --capture=.
+ *
+ * The event loop only pushes small records into a lock-free ring (see ring.c);
+ * a reporter thread samples /proc and prints them as a table, CSV, JSON lines
+ * or binary records. --trace= writes the scheduler events for uspstrace. On an
+ * error, any jobs still live are killed and reaped, and USPS exits with 1.
  */
 
-#include <fcntl.h>              /* Used for open() */
-#include <signal.h>             /* Used for signal() */
+#include <errno.h>              /* Used for errno, EINTR */
+#include <fcntl.h>              /* Used for open(), fcntl() */
+#include <pthread.h>            /* Used for pthread_create(), pthread_join() */
+#include <sched.h>              /* Used for sched_getaffinity(), sched_setaffinity() */
+#include <signal.h>             /* Used for sigaction(), sigprocmask() */
+#include <stdatomic.h>          /* Used for atomic_int, atomic_load(), atomic_store() */
+#include <stddef.h>             /* Used for offsetof() */
+#include <stdint.h>             /* Used for uint64_t */
 #include <stdlib.h>             /* Used for getenv(), free(), NULL */
-#include <sys/stat.h>           /* Needed for open() on some UNIX distributions */
-#include <sys/time.h>           /* Used for setitimer(), struct itimerval */
+#include <string.h>             /* Used for memset() */
+#include <sys/epoll.h>          /* Used for epoll_create1(), epoll_ctl(), epoll_wait() */
+#include <sys/resource.h>       /* Used for setpriority(), prlimit(), struct rusage */
+#include <sys/signalfd.h>       /* Used for signalfd(), struct signalfd_siginfo */
+#include <sys/socket.h>         /* Used for socket(), bind(), listen(), accept4() */
+#include <sys/stat.h>           /* Used for mkfifo(), stat(); needed for open() */
+#include <sys/syscall.h>        /* Used for SYS_pidfd_open, SYS_pidfd_send_signal */
+#include <sys/timerfd.h>        /* Used for timerfd_create(), timerfd_settime() */
 #include <sys/types.h>          /* Needed for open() on some UNIX distributions */
-#include <sys/wait.h>           /* Used for wait() */
-#include <time.h>               /* Used for nanosleep() */
-#include <unistd.h>             /* Used for fork(), execvp(), _exit() */
+#include <sys/un.h>             /* Used for struct sockaddr_un */
+#include <sys/wait.h>           /* Used for wait4() */
+#include <time.h>               /* Used for struct itimerspec */
+#include <unistd.h>             /* Used for fork(), execve(), access(), pipe2(), _exit() */
 #include "clist.h"              /* CList ADT */
+#include "dag.h"                /* Dag ADT */
+#include "heap.h"               /* Heap ADT */
+#include "pidmap.h"             /* PidMap ADT */
 #include "process.h"            /* Process ADT */
 #include "p1fxns.h"             /* Used for p1strcpy(), p1strcat(), p1strneq(), ... */
+#include "record.h"             /* Report events, binary report layout */
+#include "ring.h"               /* Ring ADT */
+#include "sampler.h"            /* Sampler ADT */
+#include "sched.h"              /* Scheduling policy interface */
+#include "trace.h"              /* Trace ADT */
 
-/* Macro used to suppress compiler warnings */
-#define UNUSED __attribute__((unused))
-/* Minimum quantum (in ms) allowed */
+/* Minimum quantum (in ms) allowed with --quantum= */
 #define MIN_QUANTUM 100
 /* Maximum quantum (in ms) allowed */
 #define MAX_QUANTUM 1000
-/* The time slice (in ms) for each quantum tick */
-#define SLICE 20
+/* The default time slice (in us) for each quantum tick */
+#define SLICE_US 20000
+/* Minimum time slice (in us) allowed */
+#define MIN_SLICE_US 50
+/* Longest period (in us) between checks of the blocked processes */
+#define BLOCK_POLL_US 1000
+/* Period (in ms) the reporter thread wakes up at */
+#define REPORT_PERIOD 20
+/* Maximum number of events handled per call to epoll_wait() */
+#define MAX_EVENTS 32
+/* Number of records the reporter may fall behind by before some are dropped */
+#define MAX_REPORTS 4096
+/* Niceness of the reporter thread, the lowest priority */
+#define REPORTER_NICE 19
+/* Number of connections the job socket may have waiting to be accepted */
+#define MAX_BACKLOG 16
+/* Percentage of --mem-limit= at which no more jobs are started */
+#define MEM_NEAR 90
+/* Time (in ms) a job started under --mem-limit= is given to grow, before the next */
+#define MEM_SETTLE 50
+/* Number of most recent events kept by --trace */
+#define TRACE_EVENTS 262144L
+/* First line of a CSV report, naming the columns */
+#define CSV_HEADER "time_ns,pid,event,state,syscr,syscw,rchar,wchar,read_bytes,write_bytes," \
+    "majflt,utime_ticks,stime_ticks,vsize_bytes,rss_bytes,cpu_pct,cpu_ns,cmd\n"
+/* Usage message, printed after the program name */
+#define USAGE " [--quantum=<msec>] [--quantum-us=<usec>] [--slice-us=<usec>] [--cpus=<n>] [--policy=<name>]" \
+    " [--quiet] [--output=<file_name>]" \
+    " [--format=<text|csv|jsonl|binary>] [--trace=<file_name>] [--fifo=<path>] [--socket=<path>]" \
+    " [--max-live=<n>] [--cgroup=<dir>] [--capture=<dir>] [--mem-limit=<mb>] [--mem-rlimit=<mb>]" \
+    " [workload_file] [--help]"
 
-/* Variable used for halting child processes */
-static volatile int interrupted = 0;
+/*
+ * A lane runs one process at a time, on its own CPU when pinning is enabled.
+ * The running process is taken off the lane's queue while it runs, and is put
+ * back when its quantum expires; the policy decides the order of the queue.
+ */
+typedef struct lane {
+    void *queue;                /* Processes waiting for their turn, owned by the policy */
+    Process *running;           /* The process currently running, NULL if idle */
+    int cpu;                    /* CPU that processes are pinned to, -1 if not pinned */
+    int timer_fd;               /* Slice timer of this lane */
+    unsigned long long ticked;  /* Time (in ns) of the last tick, or of arming the timer */
+} Lane;
 
-/* Number of active child processes remaining */
-static volatile long active_processes = 0L;
+/*
+ * Formats the process information may be reported in.
+ */
+typedef enum { F_TEXT, F_CSV, F_JSONL, F_BINARY } Format;
+
+/*
+ * Record pushed from the event loop to the reporter thread. It holds only what
+ * the event loop already knows; the reporter samples the rest from /proc.
+ */
+typedef struct report {
+    pid_t pid;                  /* PID of the process reported */
+    Event event;                /* What happened to it; forgotten after R_EXIT */
+    int cpu;                    /* Its CPU utilization % over the last quantum */
+    unsigned long long cputime; /* CPU time (in ns) it has used, exact after R_EXIT */
+    unsigned long long when;    /* Time (in ns) it happened at */
+} Report;
 
-/* The PID of the parent process */
-static pid_t parent_pid = 0;
+/*
+ * The captured output of a job, from its pipe to its log file
+ */
+typedef struct capture {
+    P1Writer *out;              /* Buffers the output, writing it in large blocks */
+    int log_fd;                 /* The job's log file */
+} Capture;
+
+/* Number of active child processes remaining */
+static long active_processes = 0L;
 
-/* The time quantum value */
+/* The time quantum and slice (in us) */
 static int quantum = 0;
+static int slice = SLICE_US;
+
+/* Measured time between slice ticks (in ns), and the number of ticks missed */
+static long slice_count = 0L;
+static unsigned long long slice_sum = 0ULL;
+static unsigned long long slice_min = 0ULL;
+static unsigned long long slice_max = 0ULL;
+static unsigned long long slice_missed = 0ULL;
+
+/* The scheduling policy in use, and the settings it is given */
+static Policy *policy = &adaptive_policy;
+static SchedConf conf;
+
+/* Variable 1/0 specifying whether CPU utilization is sampled around each run */
+static short sample_cpu = 0;
 
 /* Variable 1/0 specifying whether process info is printed out or not */
 static short quiet = 0;
 
 /* File descriptor where process info is printed out */
 static int output_fd = STDOUT_FILENO;
+/* Format of the process information, and where other notes go */
+static Format format = F_TEXT;
+static int notes_fd = STDOUT_FILENO;
+
+/* Time (in ns) the workload was started at, deadlines are relative to it */
+static unsigned long long start_time = 0ULL;
 
-/* Circular list that stores the processes to run */
+/* Number of processes that met/missed their deadlines, and a line for each miss */
+static long deadlines_met = 0L;
+static long deadlines_missed = 0L;
+static CList *missed_list = NULL;
+
+/* Circular list that stores the processes loaded from the workload, before forking */
 static CList *pr_list = NULL;
 
+/* Limit (in bytes) on the resident memory of the started jobs, 0 if none */
+static unsigned long mem_limit = 0UL;
+/* Limit (in bytes) on the address space of each job, 0 if none */
+static unsigned long mem_rlimit = 0UL;
+static unsigned long page_size = 4096UL;
+/* Resident memory (in bytes) of the started jobs as last sampled, and its peak */
+static unsigned long resident = 0UL;
+static unsigned long resident_peak = 0UL;
+/* Largest resident memory (in bytes) sampled of any one job */
+static unsigned long job_peak = 0UL;
+/* Number of jobs started and not yet finished, and when (in ns) the last was */
+static long started_jobs = 0L;
+static unsigned long long last_start = 0ULL;
+/* Processes held back from their first dispatch by --mem-limit=, and how often */
+static CList *deferred = NULL;
+static long deferrals = 0L;
+
+/* Directory of the per-job log files, and the captures indexed by pipe descriptor */
+static char *capture_dir = NULL;
+static PidMap *captures = NULL;
+static int max_capture = -1;
+
+/* Outcomes of the named jobs, and the jobs held until those they run after finish */
+static Dag *dag = NULL;
+static CList *held = NULL;
+/* Set once a named job finishes, so that the held jobs are checked again */
+static short dag_changed = 0;
+
+/* The workload file while jobs are still read from it, and its descriptor */
+static P1Reader *workload = NULL;
+static int workload_fd = -1;
+/* Most child processes forked at once, 0 if unlimited */
+static long max_live = 0L;
+
+/* The cgroup v2 directory each job gets a cgroup under, NULL if none */
+static char *cgroup_dir = NULL;
+
+/* The lanes processes are scheduled on, one per CPU in use */
+static Lane *lanes = NULL;
+static int nlanes = 0;
+
+/* Index of the forked processes by PID, used to reap children in O(1) */
+static PidMap *pid_map = NULL;
+
+/* The /proc sampler of each started process by PID */
+static PidMap *samplers = NULL;
+
+/* Scheduler events recorded with --trace, and the file they are written to */
+static Trace *trace = NULL;
+static int trace_fd = -1;
+
+/* Records for the reporter thread, its output, and whether it is running and should stop */
+static Ring *reports = NULL;
+static P1Writer *report_out = NULL;
+static pthread_t reporter;
+static short reporter_running = 0;
+static atomic_int reporter_done;
+/* Exits that did not fit into the ring, pushed in order once there is room */
+static CList *late_exits = NULL;
+
+/* Processes that gave up their lane while blocked, not yet runnable again */
+static CList *blocked = NULL;
+
+/* Descriptors watched by the event loop, along with each lane's timer */
+static int epoll_fd = -1;
+static int signal_fd = -1;
+static int block_timer_fd = -1;
+
+/* The signal mask in place before SIGCHLD was blocked, restored in each child */
+static sigset_t child_mask;
+
+/* Variable 1/0 specifying whether new jobs are still being admitted */
+static short serving = 0;
+/* The FIFO and listening socket jobs are submitted through, and their paths */
+static int fifo_fd = -1;
+static int listen_fd = -1;
+static char *fifo_path = NULL;
+static char *socket_path = NULL;
+/* Variable 1/0 specifying whether the FIFO was created by USPS, and is removed at exit */
+static short fifo_made = 0;
+/* The line reader of the FIFO and of each accepted connection, by descriptor */
+static PidMap *clients = NULL;
+static int max_client = -1;
+
 /* Method signatures */
-/* Populates the queue with processes given a file descriptor to read from */
+/* Opens the workload file, loading every job into the queue unless --max-live= is given */
 static void load_processes(int fd);
+/* Reads the next job from the workload file into the queue */
+static int next_job(void);
+/* Creates a process from a job line, NULL if there is nothing to run */
+static Process *parse_job(char *line, int len);
+/* Forks queued jobs until --max-live= processes are live, or none are left */
+static void fill_slots(void);
+/* Names the job in the DAG; returns 0 if the name was already taken */
+static int name_job(Process *pr);
+/* Forks the job if those it runs after have succeeded, otherwise holds or skips it */
+static void release(Process *pr);
+/* Skips a job that can no longer run, failing the jobs after it */
+static void skip_job(Process *pr, char *reason);
+/* Forks the process, and queues it on the lane stopped until it is dispatched */
+static void admit(Process *pr, Lane *ln);
+/* Creates the job's cgroup, moves the process into it */
+static void make_cgroup(Process *pr);
+/* Stores the path of the job's cgroup into 'path' */
+static void job_cgroup(pid_t pid, char *path);
+/* Opens the /proc sampler of the job led by the process */
+static Sampler *open_sampler(pid_t pid);
+/* Starts capturing the output of the child from the read end of its pipe */
+static void capture(pid_t pid, int fd);
+/* Writes out what is in the capture's pipe, closing it at end of file */
+static void read_capture(int fd);
+/* Flushes and closes the capture and its log file */
+static void close_capture(int fd);
+/* Drains and closes every capture left open */
+static void stop_capture(void);
+/* Opens the FIFO and socket that jobs are submitted through */
+static void init_serving(void);
+/* Accepts a new connection on the job socket */
+static void accept_client(void);
+/* Admits every complete job line that the FIFO or a connection has ready */
+static void read_client(int fd);
+/* Closes a connection, or the FIFO, and forgets its reader */
+static void close_client(int fd);
+/* Stops admitting new jobs, closing the FIFO, the socket and every connection */
+static void stop_serving(void);
 /* Kills the child process, sets its status to DEAD */
-static void kill_process(pid_t pid);
-/* Invoked with SIGUSR1, sends waking signal to child process */
-static void sigusr1_handler(int signo);
-/* Invoked with SIGUSR2, does nothing */
-static void sigusr2_handler(int signo);
-/* Invoked with SIGCHLD, kills the child process and wakes the parent process */
-static void sigchld_handler(int signo);
-/* Invoked with SIGALRM, selects next process for execution */
-static void sigalrm_handler(int signo);
+static void kill_process(pid_t pid, int status, struct rusage *ru);
+/* Creates the lanes, pinned to the first 'ncpus' allowed CPUs if 'ncpus' > 0 */
+static void init_lanes(int ncpus);
+/* Creates the epoll instance, the SIGCHLD signalfd, and each lane's timerfd */
+static void init_event_loop(void);
+/* Runs the event loop until all child processes have finished */
+static void run_event_loop(void);
+/* Reaps all finished child processes, marks them as DEAD */
+static void reap_children(void);
+/* Invoked on each slice tick, stops the running process when its quantum expires */
+static void on_tick(Lane *ln);
+/* Fills in the timer value of one slice */
+static void slice_timer(struct itimerspec *timer);
+/* Adds the time since the lane's last tick to the measured slices */
+static void measure_slice(Lane *ln, uint64_t expirations);
+/* Prints the measured slice lengths */
+static void print_slices(void);
+/* Returns 1 if the process is sleeping or waiting on I/O, 0 if not */
+static int is_blocked(Process *pr);
+/* Samples the resident memory of the process's job, updating the total */
+static void poll_rss(Process *pr);
+/* Returns 1 if the started jobs are near --mem-limit=, 0 if not */
+static int mem_pressure(void);
+/* Queues the deferred processes again once memory allows */
+static void release_deferred(void);
+/* Prints the peak resident memory and the number of deferrals */
+static void print_memory(void);
+/* Moves the lane's running process, which is blocked, to the blocked set */
+static void block(Lane *ln);
+/* Queues the processes in the blocked set that can run again */
+static void wake_blocked(void);
+/* Selects the next process in the lane's queue and starts or resumes it */
+static void dispatch(Lane *ln);
+/* Takes a waiting process from the lane with the longest queue */
+static int steal(Lane *ln, Process **pr);
+/* Returns the lane with the shortest queue */
+static Lane *shortest_lane(void);
+/* Returns the number of processes waiting on the lane */
+static long lane_size(Lane *ln);
+/* Queues the process on the lane */
+static int lane_insert(Lane *ln, Process *pr);
+/* Takes the next process to run off the lane's queue */
+static int lane_remove(Lane *ln, Process **pr);
+/* Warns about deadlines that cannot all be met */
+static void check_deadlines(void);
+/* Records whether a finished process met its deadline */
+static void record_deadline(Process *pr);
+/* Prints the met/missed deadline report */
+static void print_deadlines(void);
+/* Sends a signal to the job led by the child process, freezing or thawing its cgroup */
+static void send_signal(Process *pr, int signo);
+/* Kills the job led by the child process, stopped or frozen as it may be */
+static void kill_job(Process *pr);
 /* Compacts large number strings down w/ abbreviations  */
 static void compact_num(char *num);
 /* Comapcts large byte strings down w/ abbreviations */
@@ -85,10 +375,32 @@ static void ticks_to_sec(char *ticks);
 static void pages_to_bytes(char *buff);
 /* Updates and stores CPU utilization info into the process */
 static void poll_cpu(Process *pr);
-/* Adjusts the time quantum of the specified process based on its I/O behavior */
-static void adjust_quantum(Process *pr, unsigned long n_io);
+/* Records a scheduler event in the trace, if tracing */
+static void trace_event(TraceType type, Process *pr, Lane *ln);
+/* Hands a record of what happened to the process to the reporter thread */
+static void report(Process *pr, Event event);
+/* Pushes the exits held back while the ring was full, as far as there is room */
+static void push_late_exits(void);
+/* Creates the record ring and starts the reporter thread */
+static void start_reporter(void);
+/* Waits for the reporter thread to print every record left, then stops it */
+static void stop_reporter(void);
+/* Body of the reporter thread, prints a line for each record pushed */
+static void *run_reporter(void *arg);
 /* Prints out process information by accessing files in the proc directory */
-static void print(Process *pr);
+static void print(Report *rp, PidMap *sampled);
+/* Prints the abbreviated table row for the process */
+static void print_text(Report *rp, ProcStat *st, ProcIO *io, char *cmd);
+/* Prints the raw counters for the process as a CSV row or a JSON object */
+static void print_fields(Report *rp, ProcStat *st, ProcIO *io, char *cmd);
+/* Writes the raw counters for the process as a binary record */
+static void print_binary(Report *rp, ProcStat *st, ProcIO *io, char *cmd);
+/* Writes the name of the next CSV/JSON field, and the separator before it */
+static void put_field(char *name, int first);
+/* Writes a number to the report */
+static void put_num(unsigned long n);
+/* Writes a string to the report, quoted and escaped for CSV or JSON */
+static void put_quoted(char *s);
 /* Cleans up all resources used */
 static void free_mem(void);
 /* Prints the given message and exits the program */
@@ -100,45 +412,22 @@ static void print_error(char *msg);
  */
 int main(int argc, char **argv) {
 
-    Process *temp, **prs = NULL;
-    struct itimerval timer;
     char *qu_str = NULL;
+    char *qu_us_str = NULL;
     char *file = NULL;
     char *output_file = NULL;
+    char *trace_file = NULL;
     char buffer[4096];
-    char **args = NULL;
-    int i, nticks, fd = STDIN_FILENO;
-    long j, len = 0L;
-    pid_t pid;
-
-    /* Establish the SIGUSR1 signal, print error if fails */
-    if (signal(SIGUSR1, sigusr1_handler) == SIG_ERR) {
-        p1strcpy(buffer, "ERROR: Failed to establish SIGUSR1 signal.");
-        print_error(buffer);
-    }
-
-    /* Establish the SIGUSR2 signal, print error if fails */
-    if (signal(SIGUSR2, sigusr2_handler) == SIG_ERR) {
-        p1strcpy(buffer, "ERROR: Failed to establish SIGUSR2 signal.");
-        print_error(buffer);
-    }
-    parent_pid = getpid();
-
-    /* Establish the SIGCHLD signal, print error if fails */
-    if (signal(SIGCHLD, sigchld_handler) == SIG_ERR) {
-        p1strcpy(buffer, "ERROR: Failed to establish SIGCHLD signal.");
-        print_error(buffer);
-    }
-
-    /* Establish the SIGALRM signal, print error if fails */
-    if (signal(SIGALRM, sigalrm_handler) == SIG_ERR) {
-        p1strcpy(buffer, "ERROR: Failed to establish SIGALRM signal.");
-        print_error(buffer);
-    }
+    int i, ncpus = 0, fd = STDIN_FILENO;
+    long j;
 
-    /* Create the process queue, print error if allocation fails */
+    /* Create the process queue, the blocked, held and deferred sets and the DAG, print error if allocation fails */
     pr_list = cl_create();
-    if (pr_list == NULL) {
+    blocked = cl_create();
+    held = cl_create();
+    deferred = cl_create();
+    dag = dg_create();
+    if (pr_list == NULL || blocked == NULL || held == NULL || deferred == NULL || dag == NULL) {
         p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
         print_error(buffer);
     }
@@ -152,31 +441,123 @@ int main(int argc, char **argv) {
             if (p1strneq(argv[i], "--quantum=", 10)) {
                 /* Quantum specified with flag */
                 qu_str = (argv[i] + 10);
+            } else if (p1strneq(argv[i], "--quantum-us=", 13)) {
+                /* Quantum specified in microseconds */
+                qu_us_str = (argv[i] + 13);
+            } else if (p1strneq(argv[i], "--slice-us=", 11)) {
+                /* Length of each quantum tick, in microseconds */
+                slice = p1atoi(argv[i] + 11);
+            } else if (p1strneq(argv[i], "--cpus=", 7)) {
+                /* Number of lanes to run processes on */
+                ncpus = p1atoi(argv[i] + 7);
+            } else if (p1strneq(argv[i], "--policy=", 9)) {
+                /* Scheduling policy to use */
+                if ((policy = sched_find(argv[i] + 9)) == NULL) {
+                    p1strcpy(buffer, "ERROR: Unknown policy specified: ");
+                    p1strcat(buffer, argv[i] + 9);
+                    print_error(buffer);
+                }
             } else if (p1strneq(argv[i], "--quiet", 7)) {
                 /* Suppress all process info from printing out */
                 quiet = 1;
             } else if (p1strneq(argv[i], "--output=", 9)) {
                 /* Specifies file to print info out to */
                 output_file = (argv[i] + 9);
+            } else if (p1strneq(argv[i], "--trace=", 8)) {
+                /* Specifies file to write the scheduler trace to */
+                trace_file = (argv[i] + 8);
+            } else if (p1strneq(argv[i], "--fifo=", 7)) {
+                /* Named FIFO to read more jobs from while running */
+                fifo_path = (argv[i] + 7);
+            } else if (p1strneq(argv[i], "--socket=", 9)) {
+                /* Unix socket to accept more jobs on while running */
+                socket_path = (argv[i] + 9);
+            } else if (p1strneq(argv[i], "--max-live=", 11)) {
+                /* Most processes forked at once */
+                if ((max_live = p1atoi(argv[i] + 11)) < 1L) {
+                    p1strcpy(buffer, "ERROR: --max-live= must be at least 1.");
+                    print_error(buffer);
+                }
+            } else if (p1strneq(argv[i], "--mem-limit=", 12)) {
+                /* Resident memory (in MB) the started jobs may use */
+                if (p1atoi(argv[i] + 12) < 1) {
+                    p1strcpy(buffer, "ERROR: --mem-limit= must be at least 1.");
+                    print_error(buffer);
+                }
+                mem_limit = (unsigned long)p1atoi(argv[i] + 12) << 20;
+            } else if (p1strneq(argv[i], "--mem-rlimit=", 13)) {
+                /* Address space (in MB) each job may use */
+                if (p1atoi(argv[i] + 13) < 1) {
+                    p1strcpy(buffer, "ERROR: --mem-rlimit= must be at least 1.");
+                    print_error(buffer);
+                }
+                mem_rlimit = (unsigned long)p1atoi(argv[i] + 13) << 20;
+            } else if (p1strneq(argv[i], "--capture=", 10)) {
+                /* Directory to write the output of each job to */
+                capture_dir = (argv[i] + 10);
+            } else if (p1strneq(argv[i], "--cgroup=", 9)) {
+                /* Directory to create a cgroup for each job under */
+                cgroup_dir = (argv[i] + 9);
+            } else if (p1strneq(argv[i], "--format=", 9)) {
+                /* Format to print info in */
+                if (p1strneq(argv[i] + 9, "text", 5)) {
+                    format = F_TEXT;
+                } else if (p1strneq(argv[i] + 9, "csv", 4)) {
+                    format = F_CSV;
+                } else if (p1strneq(argv[i] + 9, "jsonl", 6)) {
+                    format = F_JSONL;
+                } else if (p1strneq(argv[i] + 9, "binary", 7)) {
+                    format = F_BINARY;
+                } else {
+                    p1strcpy(buffer, "ERROR: Unknown format specified: ");
+                    p1strcat(buffer, argv[i] + 9);
+                    print_error(buffer);
+                }
             } else if (p1strneq(argv[i], "--help", 6)) {
                 /* Prints usage and list of possible flags */
                 p1putstr(STDOUT_FILENO, "Usage: ");
                 p1putstr(STDOUT_FILENO, argv[0]);
-                p1putstr(STDOUT_FILENO, " [--quantum=<msec>] [--quiet] [--output=<file_name>] [workload_file] [--help]\n");
+                p1putstr(STDOUT_FILENO, USAGE "\n");
                 p1putstr(STDOUT_FILENO, "  --quantum=<msec>     : The time quantum (in ms) for each process to run.\n");
+                p1putstr(STDOUT_FILENO, "  --quantum-us=<usec>  : The time quantum in us, overrides --quantum=.\n");
+                p1putstr(STDOUT_FILENO, "  --slice-us=<usec>    : Length in us of each quantum tick (default 20000).\n");
+                p1putstr(STDOUT_FILENO, "  --cpus=<n>           : Runs up to <n> processes at once, each pinned to a CPU.\n");
+                p1putstr(STDOUT_FILENO, "  --policy=<name>      : Scheduling policy; round robin with an adaptive\n");
+                p1putstr(STDOUT_FILENO, "                         quantum (adaptive, default), round robin (rr),\n");
+                p1putstr(STDOUT_FILENO, "                         multi-level feedback queue (mlfq), fair share by\n");
+                p1putstr(STDOUT_FILENO, "                         virtual runtime (cfs), earliest deadline first\n");
+                p1putstr(STDOUT_FILENO, "                         (edf), or shortest predicted burst first (sjf).\n");
                 p1putstr(STDOUT_FILENO, "  --quiet              : Suppresses all process information from printing.\n");
                 p1putstr(STDOUT_FILENO, "  --output=<file_name> : Outputs all process information to <file_name>.\n");
+                p1putstr(STDOUT_FILENO, "  --format=<name>      : Format of the process information; an abbreviated\n");
+                p1putstr(STDOUT_FILENO, "                         table (text, default), or the raw counters as CSV\n");
+                p1putstr(STDOUT_FILENO, "                         (csv), JSON lines (jsonl), or records (binary).\n");
+                p1putstr(STDOUT_FILENO, "  --trace=<file_name>  : Writes a trace of scheduler events to <file_name>,\n");
+                p1putstr(STDOUT_FILENO, "                         to be analyzed with uspstrace.\n");
+                p1putstr(STDOUT_FILENO, "  --fifo=<path>        : Keeps running, admitting each job line written to\n");
+                p1putstr(STDOUT_FILENO, "                         the FIFO <path>, until SIGINT or SIGTERM.\n");
+                p1putstr(STDOUT_FILENO, "  --socket=<path>      : Keeps running, admitting each job line sent to the\n");
+                p1putstr(STDOUT_FILENO, "                         Unix socket <path>, until SIGINT or SIGTERM.\n");
+                p1putstr(STDOUT_FILENO, "  --max-live=<n>       : Forks at most <n> processes at once, reading the\n");
+                p1putstr(STDOUT_FILENO, "                         workload as processes finish.\n");
+                p1putstr(STDOUT_FILENO, "  --cgroup=<dir>       : Runs each job in a cgroup of its own under the\n");
+                p1putstr(STDOUT_FILENO, "                         cgroup v2 directory <dir>, frozen while stopped.\n");
+                p1putstr(STDOUT_FILENO, "  --capture=<dir>      : Writes the output of each job to <dir>/<pid>.log\n");
+                p1putstr(STDOUT_FILENO, "                         instead of the terminal.\n");
+                p1putstr(STDOUT_FILENO, "  --mem-limit=<mb>     : Holds back jobs that have not started while the\n");
+                p1putstr(STDOUT_FILENO, "                         started ones are near <mb> MB resident.\n");
+                p1putstr(STDOUT_FILENO, "  --mem-rlimit=<mb>    : Limits the address space of each job to <mb> MB.\n");
                 p1putstr(STDOUT_FILENO, "  workload_file        : The file containing the workload to run.\n");
-                p1putstr(STDOUT_FILENO, "  --help               : Displays this help message.");
-                p1strcpy(buffer, "");
-                print_error(buffer);
+                p1putstr(STDOUT_FILENO, "  --help               : Displays this help message.\n");
+                free_mem();
+                return 0;
             } else {
                 /* Illegal flag, print error/usage and exit */
                 p1strcpy(buffer, "ERROR: Illegal flag specified: ");
                 p1strcat(buffer, argv[i]);
                 p1strcat(buffer, "\nUsage: ");
                 p1strcat(buffer, argv[0]);
-                p1strcat(buffer, " [--quantum=<msec>] [--quiet] [--output=<file_name>] [workload_file] [--help]");
+                p1strcat(buffer, USAGE);
                 print_error(buffer);
             }
         } else {
@@ -185,311 +566,1887 @@ int main(int argc, char **argv) {
         }
     }
 
-    /* Quantum undefined at this point, print error and exit */
-    if (qu_str == NULL) {
-        p1strcpy(buffer, "ERROR: Quantum undefined, define through argument or env var 'USPS_QUANTUM_MSEC'.\n");
-        p1strcat(buffer, "Usage: ");
-        p1strcat(buffer, argv[0]);
-        p1strcat(buffer, " [--quantum=<msec>] [--quiet] [--output=<file_name>] [workload_file] [--help]");
-        print_error(buffer);
+    /* Quantum undefined at this point, print error and exit */
+    if (qu_str == NULL && qu_us_str == NULL) {
+        p1strcpy(buffer, "ERROR: Quantum undefined, define through argument or env var 'USPS_QUANTUM_MSEC'.\n");
+        p1strcat(buffer, "Usage: ");
+        p1strcat(buffer, argv[0]);
+        p1strcat(buffer, USAGE);
+        print_error(buffer);
+    }
+
+    /* RSS is sampled in pages */
+    if (sysconf(_SC_PAGESIZE) > 0L)
+        page_size = (unsigned long)sysconf(_SC_PAGESIZE);
+
+    /* Some policies need CPU usage to order processes even when nothing is printed */
+    sample_cpu = (!quiet || policy->sample_cpu);
+
+    /* If a file has been specified, attempt to open it */
+    if (file != NULL) {
+        if ((fd = open(file, O_RDONLY | O_CLOEXEC)) < 0) {
+            /* Failed to open file, print error and exit */
+            p1strcpy(buffer, "ERROR: Failed to open: ");
+            p1strcat(buffer, file);
+            print_error(buffer);
+        }
+    }
+
+    /* Check that jobs can be given cgroups before anything runs */
+    if (cgroup_dir != NULL) {
+        p1strcpy(buffer, cgroup_dir);
+        p1strcat(buffer, "/cgroup.procs");
+        if (access(buffer, W_OK) == -1) {
+            p1strcpy(buffer, "ERROR: Not a writable cgroup v2 directory: ");
+            p1strcat(buffer, cgroup_dir);
+            print_error(buffer);
+        }
+    }
+
+    /* Likewise, that the job logs can be written */
+    if (capture_dir != NULL && access(capture_dir, W_OK) == -1) {
+        p1strcpy(buffer, "ERROR: Not a writable directory: ");
+        p1strcat(buffer, capture_dir);
+        print_error(buffer);
+    }
+
+    /* Open the output file, creating it if it doesn't exist */
+    if (output_file != NULL) {
+        if ((output_fd = open(output_file, O_WRONLY | O_CREAT | O_TRUNC, S_IRWXU | S_IRWXG | S_IRWXO)) < 0) {
+            /* Failed to create/open output file, print error and exit */
+            p1strcpy(buffer, "ERROR: Failed to create/open: ");
+            p1strcat(buffer, output_file);
+            print_error(buffer);
+        }
+    }
+    /* Keep the deadline report and other notes out of structured output */
+    notes_fd = (format == F_TEXT) ? output_fd : STDERR_FILENO;
+
+    /* Assert that the slice is not less than minimum allowed; noted like the rest */
+    if (slice < MIN_SLICE_US) {
+        p1putstr(notes_fd, "The specified slice is less than the minimum (");
+        p1putint(notes_fd, MIN_SLICE_US);
+        p1putstr(notes_fd, " us), setting to minimum.\n");
+        slice = MIN_SLICE_US;
+    }
+
+    if (qu_us_str != NULL) {
+        /* Taken as given, at least one slice and at most the maximum */
+        quantum = p1atoi(qu_us_str);
+        if (quantum > MAX_QUANTUM * 1000) {
+            p1putstr(notes_fd, "The specified quantum is greater than the maximum (");
+            p1putint(notes_fd, MAX_QUANTUM * 1000);
+            p1putstr(notes_fd, " us), setting to maximum.\n");
+            quantum = MAX_QUANTUM * 1000;
+        }
+    } else {
+        /* Assert that the quantum is not less than minimum allowed */
+        quantum = p1atoi(qu_str);
+        if (quantum < MIN_QUANTUM) {
+            p1putstr(notes_fd, "The specified quantum is less than the minimum (");
+            p1putint(notes_fd, MIN_QUANTUM);
+            p1putstr(notes_fd, "), setting to minimum.\n");
+            quantum = MIN_QUANTUM;
+        }
+
+        /* Assert that the quantum does not exceed maximum allowed */
+        if (quantum > MAX_QUANTUM) {
+            p1putstr(notes_fd, "The specified quantum is greater than the maximum (");
+            p1putint(notes_fd, MAX_QUANTUM);
+            p1putstr(notes_fd, "), setting to maximum.\n");
+            quantum = MAX_QUANTUM;
+        }
+
+        /* Round quantum to nearest 100 */
+        quantum = (((quantum + 50) / 100) * 100) * 1000;
+    }
+    if (quantum < slice) {
+        p1putstr(notes_fd, "The specified quantum is less than one slice, setting to one slice.\n");
+        quantum = slice;
+    }
+
+    /* Hand the settings to the policy */
+    conf.quantum = quantum;
+    conf.slice = slice;
+    conf.epoch = 0ULL;
+
+    /* Open the trace file up front, so that a bad name fails before anything runs */
+    if (trace_file != NULL) {
+        if ((trace_fd = open(trace_file, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH)) < 0) {
+            p1strcpy(buffer, "ERROR: Failed to create/open: ");
+            p1strcat(buffer, trace_file);
+            print_error(buffer);
+        }
+        if ((trace = tr_create(TRACE_EVENTS)) == NULL) {
+            p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+            print_error(buffer);
+        }
+    }
+
+    /* Load the queue with the processes, given the workload file; optional if serving */
+    serving = (fifo_path != NULL || socket_path != NULL);
+    if (file != NULL || !serving)
+        load_processes(fd);
+
+    /* Set up the lanes and event loop before forking, so that no SIGCHLD is missed */
+    init_lanes(ncpus);
+    init_event_loop();
+    if (serving)
+        init_serving();
+
+    /* Admission control, warn if the deadlines cannot all be met; only those
+       loaded up front are checked, so none with --max-live= */
+    if ((missed_list = cl_create()) == NULL) {
+        p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+        print_error(buffer);
+    }
+    check_deadlines();
+    conf.epoch = start_time = sched_now();
+
+    /* Create the PID indexes, sized for the most processes live at once */
+    j = (max_live > 0L) ? max_live : cl_size(pr_list);
+    if ((pid_map = pm_create(j)) == NULL || (samplers = pm_create(j)) == NULL ||
+            (capture_dir != NULL && (captures = pm_create(j)) == NULL)) {
+        p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+        print_error(buffer);
+    }
+
+    /* Fork the processes, dealing them out to the lanes in turn */
+    fill_slots();
+
+    /* Start the reporter; children forked from now on only exec, see admit() */
+    if (!quiet)
+        start_reporter();
+
+    /* Start the first process on each lane, then wait on events until all have completed */
+    run_event_loop();
+    stop_capture();
+    stop_reporter();
+    print_slices();
+    print_memory();
+    print_deadlines();
+
+    /* Write out the trace */
+    if (trace != NULL && !tr_dump(trace, trace_fd, slice)) {
+        p1strcpy(buffer, "ERROR: Failed to write the trace to: ");
+        p1strcat(buffer, trace_file);
+        print_error(buffer);
+    }
+
+    /* Free all allocated memory */
+    free_mem();
+
+    return 0;
+}
+
+/*
+ * Opens the workload file for reading, given its file descriptor. Unless the
+ * number of live processes is limited with --max-live=, every job is loaded into
+ * the process list right away and the file is closed; otherwise jobs are read as
+ * they are needed (see fill_slots()).
+ */
+static void load_processes(int fd) {
+
+    char buffer[256];
+
+    /* Read the file in blocks rather than a byte at a time */
+    workload_fd = fd;
+    if ((workload = p1ropen(fd)) == NULL) {
+        p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory");
+        print_error(buffer);
+    }
+
+    if (max_live == 0L)
+        while (next_job())
+            ;
+}
+
+/*
+ * Reads the next job line from the workload file, creates a process from it, and
+ * adds it into the process list. Closes the file once every line is read. Returns
+ * 1 if a process was added, 0 if the file is done.
+ */
+static int next_job(void) {
+
+    Process *pr;
+    char buffer[256];
+    char *line;
+    int len;
+
+    while (workload != NULL) {
+        if ((line = p1rgetline(workload, &len)) == NULL) {
+            /* File no longer needed, close it */
+            p1rclose(workload);
+            workload = NULL;
+            if (workload_fd != STDIN_FILENO)
+                close(workload_fd);
+            workload_fd = -1;
+            break;
+        }
+        if ((pr = parse_job(line, len)) == NULL)
+            continue;
+
+        /* Insert the new struct instance into list */
+        if (!cl_insert(pr_list, pr)) {
+            /* Insertion failed, print error and exit */
+            free_pr(pr);
+            p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory");
+            print_error(buffer);
+        }
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Creates a process from a line of the workload file, or one that was submitted,
+ * of length 'len'. Returns NULL for a blank line, or one with only attributes.
+ */
+static Process *parse_job(char *line, int len) {
+
+    Process *pr;
+    char buffer[256], word[1024];
+
+    /* Ignores blank lines */
+    p1getword(line, 0, word);
+    if (p1strneq(word, "\n", 1))
+        return NULL;
+
+    /* Trim off newline */
+    if (line[len - 1] == '\n')
+        line[len - 1] = '\0';
+
+    /* Creates the process from the given line */
+    if ((pr = malloc_pr(line)) == NULL) {
+        /* Allocation failed, print error and exit */
+        p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory");
+        print_error(buffer);
+    }
+
+    /* Nothing to execute */
+    if (pr_argv(pr)[0] == NULL) {
+        free_pr(pr);
+        pr = NULL;
+    }
+
+    return pr;
+}
+
+/*
+ * Forks the processes in the process list, then those left in the workload file,
+ * onto the lane with the fewest processes waiting, until --max-live= processes
+ * are live or there are none left. Submitted jobs are forked ahead of the rest
+ * of the workload file. Held jobs are checked first, once a named job has
+ * finished, and keep their order among themselves.
+ */
+static void fill_slots(void) {
+
+    Process *pr;
+    char buffer[256];
+    long i;
+
+    if (dag_changed) {
+        dag_changed = 0;
+        for (i = cl_size(held); i > 0L; i--) {
+            cl_remove(held, (void **)&pr);
+            if (max_live != 0L && active_processes >= max_live) {
+                /* No room for it yet, check it again once there is */
+                if (!cl_insert(held, pr)) {
+                    free_pr(pr);
+                    p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+                    print_error(buffer);
+                }
+                dag_changed = 1;
+                continue;
+            }
+            release(pr);
+        }
+    }
+
+    while (max_live == 0L || active_processes < max_live) {
+        if (cl_size(pr_list) == 0L && !next_job())
+            break;
+        cl_remove(pr_list, (void **)&pr);
+        if (name_job(pr))
+            release(pr);
+    }
+}
+
+/*
+ * Names the job in the DAG, when it has a name. A job only runs after jobs named
+ * before it, so names are taken in the order jobs leave the process list. A job
+ * reusing a name is skipped, leaving the outcome of the first one alone. Returns
+ * 1 if the job may go on, 0 if it was skipped.
+ */
+static int name_job(Process *pr) {
+
+    char buffer[4096];
+    int i;
+
+    if (pr_name(pr) == NULL)
+        return 1;
+    switch (dg_add(dag, pr_name(pr))) {
+        case 1:
+            return 1;
+        case 0:
+            free_pr(pr);
+            p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+            print_error(buffer);
+            return 0;
+        default:
+            p1strcpy(buffer, "WARNING: Skipped, the name ");
+            p1strcat(buffer, pr_name(pr));
+            p1strcat(buffer, " is already taken:");
+            for (i = 0; pr_argv(pr)[i] != NULL; i++) {
+                p1strcat(buffer, " ");
+                p1strcat(buffer, pr_argv(pr)[i]);
+            }
+            p1strcat(buffer, "\n");
+            p1putstr(notes_fd, buffer);
+            free_pr(pr);
+            return 0;
+    }
+}
+
+/*
+ * Forks the job onto the lane with the fewest processes waiting if every job it
+ * runs after has succeeded. Holds it while any of them has yet to finish, and
+ * skips it once one of them has failed or was never named.
+ */
+static void release(Process *pr) {
+
+    char buffer[256];
+
+    switch ((pr_after(pr) != NULL) ? dg_check(dag, pr_after(pr)) : DG_READY) {
+        case DG_READY:
+            admit(pr, shortest_lane());
+            break;
+        case DG_WAITING:
+            if (!cl_insert(held, pr)) {
+                free_pr(pr);
+                p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+                print_error(buffer);
+            }
+            break;
+        case DG_FAILED:
+            skip_job(pr, "a job it runs after failed");
+            break;
+        default:
+            skip_job(pr, "it runs after a job that is not named before it");
+            break;
+    }
+}
+
+/*
+ * Skips the job, giving the reason, and records it as failed so that the jobs
+ * after it are skipped in turn.
+ */
+static void skip_job(Process *pr, char *reason) {
+
+    char buffer[4096];
+    int i;
+
+    p1strcpy(buffer, "WARNING: Skipped, ");
+    p1strcat(buffer, reason);
+    p1strcat(buffer, ":");
+    for (i = 0; pr_argv(pr)[i] != NULL; i++) {
+        p1strcat(buffer, " ");
+        p1strcat(buffer, pr_argv(pr)[i]);
+    }
+    p1strcat(buffer, "\n");
+    p1putstr(notes_fd, buffer);
+
+    if (pr_name(pr) != NULL) {
+        dg_finish(dag, pr_name(pr), 0);
+        dag_changed = 1;
+    }
+    free_pr(pr);
+}
+
+/*
+ * Finds the program to invoke the way execvp() would, searching each directory
+ * in PATH unless the name has a '/' in it, and copies its path into 'path'. If
+ * it is not found, the name itself is copied, and exec reports the error. Done
+ * in the parent, since execvp() may allocate memory, which the child must not.
+ */
+static void find_program(char *name, char *path, int size) {
+
+    char *dirs = getenv("PATH");
+    int i, len, n = p1strlen(name);
+
+    p1strcpy(path, name);
+    if (p1strchr(name, '/') != -1 || n == 0 || n >= size)
+        return;
+    if (dirs == NULL)
+        dirs = "/bin:/usr/bin";
+
+    for (;;) {
+        /* Find the end of the next directory; an empty one is the current one */
+        if ((len = p1strchr(dirs, ':')) == -1)
+            len = p1strlen(dirs);
+        if (len + n + 3 <= size) {
+            for (i = 0; i < len; i++)
+                path[i] = dirs[i];
+            if (len == 0)
+                path[i++] = '.';
+            path[i++] = '/';
+            p1strcpy(path + i, name);
+            if (access(path, X_OK) == 0)
+                return;
+        }
+        if (dirs[len] == '\0')
+            break;
+        dirs += len + 1;
+    }
+    p1strcpy(path, name);
+}
+
+/*
+ * Forks the process and queues it on the lane. The child stops itself until it
+ * is first dispatched with SIGCONT, then invokes execve() on the program found
+ * beforehand. The reporter thread may be running, and may hold a lock at the
+ * time of fork(), so the child only calls async-signal-safe functions before
+ * exec, allocates nothing, and does not free anything if exec fails; the path
+ * search and the address space limit are done by the parent instead.
+ */
+static void admit(Process *pr, Lane *ln) {
+
+    pid_t pid;
+    struct rlimit rl;
+    char buffer[4096], path[4096];
+    char **args;
+    int i, out[2] = { -1, -1 };
+
+    /* The pipe the job's output is captured through */
+    if (capture_dir != NULL && pipe2(out, O_CLOEXEC) == -1) {
+        free_pr(pr);
+        p1strcpy(buffer, "ERROR: Failed to create a pipe to capture output.");
+        print_error(buffer);
+    }
+
+    /* Everything the child needs is found before fork(), it must not allocate */
+    args = pr_argv(pr);
+    find_program(args[0], path, sizeof(path));
+
+    pid = fork();
+    if (pid == 0) {
+        /* Child must not inherit the blocked SIGCHLD into the program */
+        sigprocmask(SIG_SETMASK, &child_mask, NULL);
+        /* Write to the capture pipe instead of the terminal; the copies stay open */
+        if (out[1] != -1) {
+            dup2(out[1], STDOUT_FILENO);
+            dup2(out[1], STDERR_FILENO);
+        }
+        /* Lead a process group of its own, so that its whole job is stopped at once */
+        setpgid(0, 0);
+        /* Nor read the rest of the workload, when it is still read from stdin */
+        if (workload != NULL && workload_fd == STDIN_FILENO &&
+                (i = open("/dev/null", O_RDONLY)) != -1) {
+            dup2(i, STDIN_FILENO);
+            close(i);
+        }
+        /* The child stops itself here until it is first dispatched with SIGCONT */
+        kill(getpid(), SIGSTOP);
+        /* Child process, invoke execve() on program */
+        execve(path, args, environ);
+        /* If this is reached, error occured invoking the program */
+        /* Print error message and exit */
+        p1strcpy(buffer, "ERROR: Failed to execute:");
+        for (i = 0; args[i] != NULL; i++) {
+            p1strcat(buffer, " ");
+            p1strcat(buffer, args[i]);
+        }
+        p1strcat(buffer, "\n");
+        p1putstr(STDOUT_FILENO, buffer);
+        _exit(1);
+    } else if (pid > 0) {
+        /* Parent process, assign the PID, let the policy set its quantum */
+        assign_pid(pr, pid);
+        active_processes++;
+        /* Only the child writes to the pipe, so that it ends once the job is done */
+        if (out[1] != -1) {
+            close(out[1]);
+            capture(pid, out[0]);
+        }
+        /* Set the group here too, so that it is in place whichever runs first */
+        setpgid(pid, pid);
+        /* Cap its address space, inherited by everything the job forks; it does
+           not exec before it is dispatched, so the limit is in place by then */
+        if (mem_rlimit != 0UL) {
+            rl.rlim_cur = rl.rlim_max = (rlim_t)mem_rlimit;
+            if (prlimit(pid, RLIMIT_AS, &rl, NULL) == -1) {
+                p1strcpy(buffer, "WARNING: Failed to limit the address space of a process.\n");
+                p1putstr(notes_fd, buffer);
+            }
+        }
+        if (cgroup_dir != NULL)
+            make_cgroup(pr);
+        (*policy->admit)(ln->queue, pr);
+        /* Index by PID, and queue it on the lane */
+        if (!pm_put(pid_map, pid, pr) || !lane_insert(ln, pr)) {
+            /* Not indexed yet, so print_error() would not find it */
+            kill_job(pr);
+            p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+            print_error(buffer);
+        }
+        trace_event(T_ADMIT, pr, ln);
+    } else {
+        /* Fork error, print error and exit */
+        free_pr(pr);
+        p1strcpy(buffer, "ERROR: Previous call to fork() failed.");
+        print_error(buffer);
+    }
+}
+
+/*
+ * Creates the cgroup of the job led by the process, under --cgroup=, and moves
+ * the process into it; it is stopped until its first dispatch, so everything it
+ * forks starts out in the cgroup too. Keeps the cgroup.freeze file open, to stop
+ * and continue the job with (see send_signal()).
+ */
+static void make_cgroup(Process *pr) {
+
+    char path[4096], buffer[4096], pid_str[32];
+    int fd, ok;
+
+    job_cgroup(pr_pid(pr), path);
+    p1itoa((int)pr_pid(pr), pid_str);
+    ok = (mkdir(path, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) == 0);
+
+    /* Move the process in */
+    p1strcpy(buffer, path);
+    p1strcat(buffer, "/cgroup.procs");
+    if (ok && (fd = open(buffer, O_WRONLY | O_CLOEXEC)) != -1) {
+        ok = (write(fd, pid_str, p1strlen(pid_str)) == p1strlen(pid_str));
+        close(fd);
+    } else {
+        ok = 0;
+    }
+
+    p1strcpy(buffer, path);
+    p1strcat(buffer, "/cgroup.freeze");
+    if (!ok || (fd = open(buffer, O_WRONLY | O_CLOEXEC)) == -1) {
+        p1strcpy(buffer, "ERROR: Failed to create the cgroup: ");
+        p1strcat(buffer, path);
+        print_error(buffer);
+    }
+    assign_freezer(pr, fd);
+}
+
+/*
+ * Stores the path of the cgroup of the job led by the process with the given PID
+ * into 'path'.
+ */
+static void job_cgroup(pid_t pid, char *path) {
+
+    char pid_str[32];
+
+    p1itoa((int)pid, pid_str);
+    p1strcpy(path, cgroup_dir);
+    p1strcat(path, "/usps-");
+    p1strcat(path, pid_str);
+}
+
+/*
+ * Opens the /proc sampler of the job led by the process with the given PID; its
+ * processes are those in the job's cgroup, or else its descendants. Used by both
+ * the event loop and the reporter thread.
+ */
+static Sampler *open_sampler(pid_t pid) {
+
+    char path[4096];
+
+    if (cgroup_dir == NULL)
+        return sm_open_job(pid, NULL);
+
+    job_cgroup(pid, path);
+    p1strcat(path, "/cgroup.procs");
+
+    return sm_open_job(pid, path);
+}
+
+/*
+ * Opens the log file <dir>/<pid>.log of the child under --capture=, and watches
+ * the read end 'fd' of the pipe its output goes to in the event loop.
+ */
+static void capture(pid_t pid, int fd) {
+
+    struct epoll_event ev;
+    Capture *cp;
+    char path[4096], buffer[4096], pid_str[32];
+
+    p1strcpy(path, capture_dir);
+    p1strcat(path, "/");
+    p1itoa((int)pid, pid_str);
+    p1strcat(path, pid_str);
+    p1strcat(path, ".log");
+
+    if ((cp = (Capture *)malloc(sizeof(Capture))) == NULL) {
+        close(fd);
+        p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+        print_error(buffer);
+    }
+    if ((cp->log_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH)) < 0) {
+        free(cp);
+        close(fd);
+        p1strcpy(buffer, "ERROR: Failed to create/open: ");
+        p1strcat(buffer, path);
+        print_error(buffer);
+    }
+    if ((cp->out = p1wopen(cp->log_fd)) == NULL || !pm_put(captures, fd, cp)) {
+        p1wclose(cp->out);
+        close(cp->log_fd);
+        free(cp);
+        close(fd);
+        p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+        print_error(buffer);
+    }
+    if (fd > max_capture)
+        max_capture = fd;
+
+    /* Read as it arrives, never waiting on a job that has nothing to say */
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        p1strcpy(buffer, "ERROR: Failed to add a capture pipe to the event loop.");
+        print_error(buffer);
+    }
+}
+
+/*
+ * Moves everything in the capture's pipe into its writer, which writes it to
+ * the log file whenever its buffer fills. Closes the capture once every process
+ * of the job has closed the pipe.
+ */
+static void read_capture(int fd) {
+
+    Capture *cp = (Capture *)pm_get(captures, fd);
+    char buffer[P1R_BUFSIZE];
+    ssize_t n;
+
+    for (;;) {
+        if ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+            p1wwrite(cp->out, buffer, (int)n);
+            continue;
+        }
+        if (n == -1 && errno == EINTR)
+            continue;
+        /* Nothing more for now */
+        if (n == -1 && errno == EAGAIN)
+            return;
+        break;
+    }
+
+    /* End of file, or the pipe failed */
+    close_capture(fd);
+}
+
+/*
+ * Writes out what is left in the capture's writer, then closes its log file and
+ * pipe; closing the pipe removes it from the event loop.
+ */
+static void close_capture(int fd) {
+
+    Capture *cp;
+
+    if ((cp = (Capture *)pm_remove(captures, fd)) == NULL)
+        return;
+    p1wclose(cp->out);
+    close(cp->log_fd);
+    free(cp);
+    close(fd);
+}
+
+/*
+ * Writes out what the jobs left in their pipes, and closes every capture; also
+ * those still held open by processes that outlived their job.
+ */
+static void stop_capture(void) {
+
+    int fd;
+
+    if (captures == NULL)
+        return;
+    for (fd = 0; fd <= max_capture; fd++) {
+        if (pm_get(captures, fd) != NULL) {
+            read_capture(fd);
+            close_capture(fd);
+        }
+    }
+    pm_destroy(captures, NULL);
+    captures = NULL;
+}
+
+/*
+ * Opens the FIFO and the listening socket given with --fifo= and --socket=, and
+ * registers them with the event loop. The FIFO is created if it does not exist,
+ * and is opened for writing as well as reading, so that it never reaches end of
+ * file when a submitter closes it. SIGINT and SIGTERM are read from the signalfd
+ * (see init_event_loop()), and stop the admission of new jobs.
+ */
+static void init_serving(void) {
+
+    struct sockaddr_un addr;
+    struct epoll_event ev;
+    struct stat st;
+    P1Reader *rd;
+    char buffer[4096];
+
+    if ((clients = pm_create(MAX_BACKLOG)) == NULL) {
+        p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+        print_error(buffer);
+    }
+    ev.events = EPOLLIN;
+
+    if (fifo_path != NULL) {
+        if (stat(fifo_path, &st) == -1) {
+            if (mkfifo(fifo_path, S_IRUSR | S_IWUSR) == -1) {
+                p1strcpy(buffer, "ERROR: Failed to create the FIFO: ");
+                p1strcat(buffer, fifo_path);
+                print_error(buffer);
+            }
+            fifo_made = 1;
+        } else if (!S_ISFIFO(st.st_mode)) {
+            p1strcpy(buffer, "ERROR: Not a FIFO: ");
+            p1strcat(buffer, fifo_path);
+            print_error(buffer);
+        }
+        if ((fifo_fd = open(fifo_path, O_RDWR | O_NONBLOCK | O_CLOEXEC)) < 0) {
+            p1strcpy(buffer, "ERROR: Failed to open: ");
+            p1strcat(buffer, fifo_path);
+            print_error(buffer);
+        }
+        /* Read like any connection, it just never closes */
+        if ((rd = p1ropen(fifo_fd)) == NULL || !pm_put(clients, fifo_fd, rd)) {
+            p1rclose(rd);
+            p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+            print_error(buffer);
+        }
+        max_client = fifo_fd;
+        ev.data.fd = fifo_fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fifo_fd, &ev) == -1) {
+            p1strcpy(buffer, "ERROR: Failed to create the event loop.");
+            print_error(buffer);
+        }
+    }
+
+    if (socket_path != NULL) {
+        if (p1strlen(socket_path) >= (int)sizeof(addr.sun_path)) {
+            p1strcpy(buffer, "ERROR: Socket path is too long: ");
+            p1strcat(buffer, socket_path);
+            print_error(buffer);
+        }
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        p1strcpy(addr.sun_path, socket_path);
+        if ((listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) == -1 ||
+                bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+            p1strcpy(buffer, "ERROR: Failed to bind the socket: ");
+            p1strcat(buffer, socket_path);
+            /* Do not remove a socket this program did not create */
+            socket_path = NULL;
+            print_error(buffer);
+        }
+        ev.data.fd = listen_fd;
+        if (listen(listen_fd, MAX_BACKLOG) == -1 ||
+                epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev) == -1) {
+            p1strcpy(buffer, "ERROR: Failed to listen on the socket: ");
+            p1strcat(buffer, socket_path);
+            print_error(buffer);
+        }
+    }
+}
+
+/*
+ * Accepts every connection waiting on the job socket, and registers each with
+ * the event loop along with a line reader.
+ */
+static void accept_client(void) {
+
+    struct epoll_event ev;
+    P1Reader *rd;
+    int fd;
+
+    while ((fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1) {
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if ((rd = p1ropen(fd)) != NULL && pm_put(clients, fd, rd)) {
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != -1) {
+                if (fd > max_client)
+                    max_client = fd;
+                continue;
+            }
+            pm_remove(clients, fd);
+        }
+        /* Refuse the connection rather than give up on the rest */
+        p1rclose(rd);
+        close(fd);
+    }
+}
+
+/*
+ * Reads every complete job line ready on the FIFO or connection, and forks each
+ * as a slot is free (see fill_slots()). A connection is closed once the submitter
+ * closes its end. Lines are parsed like those of the workload file.
+ */
+static void read_client(int fd) {
+
+    P1Reader *rd = (P1Reader *)pm_get(clients, fd);
+    Process *pr;
+    char buffer[256];
+    char *line;
+    int len;
+
+    while ((line = p1rgetline(rd, &len)) != NULL) {
+        if ((pr = parse_job(line, len)) == NULL)
+            continue;
+        if (!cl_insert(pr_list, pr)) {
+            free_pr(pr);
+            p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory");
+            print_error(buffer);
+        }
+    }
+    fill_slots();
+
+    /* Submitter closed its end, or the connection failed */
+    if (len == 0 || errno != EAGAIN)
+        close_client(fd);
+}
+
+/*
+ * Closes the connection or FIFO with the specified descriptor, and destroys its
+ * reader. Closing the descriptor also removes it from the epoll instance.
+ */
+static void close_client(int fd) {
+
+    P1Reader *rd;
+
+    if ((rd = (P1Reader *)pm_remove(clients, fd)) == NULL)
+        return;
+    p1rclose(rd);
+    close(fd);
+    if (fd == fifo_fd)
+        fifo_fd = -1;
+}
+
+/*
+ * Stops admitting new jobs. Closes the listening socket and every connection,
+ * and the FIFO, removing the socket, and the FIFO if it was created by USPS.
+ * Anything not yet read from them is discarded.
+ */
+static void stop_serving(void) {
+
+    int fd;
+
+    serving = 0;
+    if (listen_fd != -1) {
+        close(listen_fd);
+        listen_fd = -1;
+        if (socket_path != NULL)
+            unlink(socket_path);
+    }
+    if (fifo_fd != -1)
+        close_client(fifo_fd);
+    if (fifo_made) {
+        unlink(fifo_path);
+        fifo_made = 0;
+    }
+    if (clients != NULL) {
+        for (fd = 0; fd <= max_client; fd++)
+            close_client(fd);
+        pm_destroy(clients, NULL);
+        clients = NULL;
+    }
+}
+
+/*
+ * Kills the child process with the specified PID. Sets its status
+ * to DEAD, such that, it will be removed from its lane when its next
+ * selected by the scheduler to run. A running process is held by its
+ * lane rather than its queue, so it is dropped right away by the event
+ * loop; looking the process up through the PID index keeps reaping O(1)
+ * and free of any allocation. 'ru' is the resource usage wait4() returned
+ * for it, which gives the exact CPU time of its job.
+ */
+static void kill_process(pid_t pid, int status, struct rusage *ru) {
+
+    Process *pr;
+    char path[4096];
+
+    /* Find the child process, drop it from the index */
+    if ((pr = (Process *)pm_remove(pid_map, pid)) == NULL)
+        return;
+
+    /* Its memory is no longer resident */
+    if (pr_status(pr) == ALIVE)
+        started_jobs--;
+    resident -= pr_rss(pr);
+    pr_poll_rss(pr, 0UL);
+
+    /* Sets its status to DEAD, releases its pidfd and /proc files */
+    pr_kill(pr);
+    pr_poll_cpu(pr, sched_now(),
+        (ru->ru_utime.tv_sec + ru->ru_stime.tv_sec) * 1000000000ULL +
+        (ru->ru_utime.tv_usec + ru->ru_stime.tv_usec) * 1000ULL);
+    record_deadline(pr);
+    trace_event(T_EXIT, pr, NULL);
+    /* Release or fail the jobs held until it finished */
+    if (pr_name(pr) != NULL) {
+        dg_finish(dag, pr_name(pr), WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        dag_changed = 1;
+    }
+    if (reports != NULL)
+        report(pr, R_EXIT);
+    sm_close((Sampler *)pm_remove(samplers, pid));
+    if (pr_pidfd(pr) != -1) {
+        close(pr_pidfd(pr));
+        assign_pidfd(pr, -1);
+    }
+
+    /* Let anything left of the job run out, remove the cgroup once it is empty */
+    if (pr_freezer(pr) != -1) {
+        (void)write(pr_freezer(pr), "0", 1);
+        close(pr_freezer(pr));
+        assign_freezer(pr, -1);
+        job_cgroup(pid, path);
+        rmdir(path);
+    }
+}
+
+/*
+ * Creates the lanes that processes are scheduled on. If 'ncpus' is 0, a single
+ * lane is created and nothing is pinned, as in the earlier versions. Otherwise,
+ * one lane is created for each of the first 'ncpus' CPUs this program may run on,
+ * up to the number of such CPUs.
+ */
+static void init_lanes(int ncpus) {
+
+    cpu_set_t allowed;
+    int i, cpu = 0, navail = 1;
+    char buffer[256];
+
+    /* Find the CPUs we are allowed to run on */
+    if (ncpus > 0) {
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == -1) {
+            p1strcpy(buffer, "ERROR: Failed to read the CPU affinity mask.");
+            print_error(buffer);
+        }
+        navail = CPU_COUNT(&allowed);
+        if (ncpus > navail) {
+            p1putstr(notes_fd, "The specified number of CPUs is greater than the number available (");
+            p1putint(notes_fd, navail);
+            p1putstr(notes_fd, "), setting to maximum.\n");
+            ncpus = navail;
+        }
+    }
+
+    nlanes = (ncpus > 0) ? ncpus : 1;
+    if ((lanes = (Lane *)malloc(sizeof(Lane) * nlanes)) == NULL) {
+        p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+        print_error(buffer);
+    }
+    for (i = 0; i < nlanes; i++) {
+        lanes[i].queue = NULL;
+        lanes[i].running = NULL;
+        lanes[i].cpu = -1;
+        lanes[i].timer_fd = -1;
+        lanes[i].ticked = 0ULL;
+    }
+
+    for (i = 0; i < nlanes; i++) {
+        if ((lanes[i].queue = (*policy->create)(&conf)) == NULL) {
+            p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+            print_error(buffer);
+        }
+        /* Assign the next allowed CPU to the lane */
+        if (ncpus > 0) {
+            while (!CPU_ISSET(cpu, &allowed))
+                cpu++;
+            lanes[i].cpu = cpu++;
+        }
+    }
+}
+
+/*
+ * Creates the epoll instance and registers the descriptors that drive the
+ * scheduler: a signalfd that receives SIGCHLD, and a timerfd for each lane that
+ * fires once per time slice. SIGCHLD is blocked so that it is only ever
+ * delivered through the signalfd; SA_NOCLDSTOP keeps our own SIGSTOPs from
+ * generating it.
+ */
+static void init_event_loop(void) {
+
+    struct sigaction act;
+    struct epoll_event ev;
+    sigset_t mask;
+    int i;
+    char buffer[256];
+
+    /* Only child termination should generate SIGCHLD */
+    act.sa_handler = SIG_DFL;
+    act.sa_flags = SA_NOCLDSTOP;
+    sigemptyset(&act.sa_mask);
+    if (sigaction(SIGCHLD, &act, NULL) == -1) {
+        p1strcpy(buffer, "ERROR: Failed to establish SIGCHLD signal.");
+        print_error(buffer);
+    }
+
+    /* Block SIGCHLD, so that it is queued for the signalfd instead; likewise
+       SIGINT and SIGTERM while serving, which stop the admission of jobs */
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    if (serving) {
+        sigaddset(&mask, SIGINT);
+        sigaddset(&mask, SIGTERM);
+    }
+    if (sigprocmask(SIG_BLOCK, &mask, &child_mask) == -1 ||
+            (signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC)) == -1) {
+        p1strcpy(buffer, "ERROR: Failed to create the SIGCHLD signalfd.");
+        print_error(buffer);
+    }
+
+    /* Register the signalfd with a new epoll instance */
+    if ((epoll_fd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+        p1strcpy(buffer, "ERROR: Failed to create the event loop.");
+        print_error(buffer);
+    }
+    ev.events = EPOLLIN;
+    ev.data.fd = signal_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, signal_fd, &ev) == -1) {
+        p1strcpy(buffer, "ERROR: Failed to create the event loop.");
+        print_error(buffer);
+    }
+
+    /* Checks the blocked set once per slice while it is not empty, see block() */
+    if ((block_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) == -1) {
+        p1strcpy(buffer, "ERROR: Failed to create the quantum timer.");
+        print_error(buffer);
+    }
+    ev.data.fd = block_timer_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, block_timer_fd, &ev) == -1) {
+        p1strcpy(buffer, "ERROR: Failed to create the event loop.");
+        print_error(buffer);
+    }
+
+    /* Timers are armed on each dispatch, see dispatch() */
+    for (i = 0; i < nlanes; i++) {
+        if ((lanes[i].timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) == -1) {
+            p1strcpy(buffer, "ERROR: Failed to create the quantum timer.");
+            print_error(buffer);
+        }
+        ev.data.fd = lanes[i].timer_fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, lanes[i].timer_fd, &ev) == -1) {
+            p1strcpy(buffer, "ERROR: Failed to create the event loop.");
+            print_error(buffer);
+        }
+    }
+}
+
+/*
+ * Waits on the epoll instance until every child process has finished, and no more
+ * jobs are being admitted. Before each wait, jobs are forked into free slots and
+ * idle lanes are dispatched. Timer expirations advance the quantum of the lane's
+ * running process; signalfd and pidfd readiness both mean that at least one child
+ * has exited and can be reaped. The job socket, FIFO and connections admit any
+ * job lines they have ready.
+ */
+static void run_event_loop(void) {
+
+    struct epoll_event events[MAX_EVENTS];
+    struct signalfd_siginfo info;
+    Lane *ln;
+    uint64_t expirations;
+    int i, j, n, timeout;
+    char buffer[256];
+
+    for (;;) {
+        for (j = 0; j < nlanes; j++) {
+            ln = &lanes[j];
+            /* Running process finished, hand the lane to the next one right away */
+            if (ln->running != NULL && pr_status(ln->running) == DEAD) {
+                if (policy->on_exit != NULL)
+                    (*policy->on_exit)(ln->queue, ln->running);
+                free_pr(ln->running);
+                ln->running = NULL;
+            }
+        }
+        release_deferred();
+        fill_slots();
+        /* Idle lanes look for work, possibly stolen from another lane */
+        for (j = 0; j < nlanes; j++)
+            if (lanes[j].running == NULL)
+                dispatch(&lanes[j]);
+
+        /* Done once every job has finished and no more can arrive */
+        if (active_processes == 0L) {
+            if (cl_size(pr_list) > 0L || workload != NULL || dag_changed)
+                continue;
+            if (!serving)
+                break;
+        }
+
+        /* Exits held back from a full ring are retried once the reporter catches up */
+        if (reports != NULL)
+            push_late_exits();
+        timeout = (late_exits != NULL && !cl_isEmpty(late_exits)) ? REPORT_PERIOD : -1;
+        if ((n = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout)) == -1) {
+            if (errno == EINTR)
+                continue;
+            p1strcpy(buffer, "ERROR: Failed to wait on the event loop.");
+            print_error(buffer);
+        }
+
+        for (i = 0; i < n; i++) {
+            if (events[i].data.fd == signal_fd) {
+                /* Drain the queued signals, then reap */
+                while (read(signal_fd, &info, sizeof(info)) == sizeof(info))
+                    if (info.ssi_signo != SIGCHLD && serving)
+                        stop_serving();
+                reap_children();
+                continue;
+            }
+            if (events[i].data.fd == block_timer_fd) {
+                /* Requeue the blocked processes that are runnable again */
+                if (read(block_timer_fd, &expirations, sizeof(expirations)) == sizeof(expirations))
+                    wake_blocked();
+                continue;
+            }
+            if (events[i].data.fd == listen_fd) {
+                accept_client();
+                continue;
+            }
+            if (clients != NULL && pm_get(clients, events[i].data.fd) != NULL) {
+                read_client(events[i].data.fd);
+                continue;
+            }
+            if (captures != NULL && pm_get(captures, events[i].data.fd) != NULL) {
+                read_capture(events[i].data.fd);
+                continue;
+            }
+            for (j = 0; j < nlanes; j++)
+                if (events[i].data.fd == lanes[j].timer_fd)
+                    break;
+            if (j < nlanes) {
+                /* Slice tick; missed expirations are folded into one tick */
+                ln = &lanes[j];
+                if (read(ln->timer_fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+                    measure_slice(ln, expirations);
+                    on_tick(ln);
+                }
+            } else {
+                /* A pidfd became readable; its child has exited */
+                reap_children();
+            }
+        }
+    }
+}
+
+/*
+ * Reaps every child that has finished, marking it as DEAD so that it can be
+ * removed from its lane.
+ */
+static void reap_children(void) {
+
+    struct rusage ru;
+    pid_t pid;
+    int status;
+
+    while ((pid = wait4(-1, &status, WNOHANG, &ru)) > 0) {
+        if (WIFEXITED(status) || WIFSIGNALED(status)) {
+            kill_process(pid, status, &ru);
+            active_processes--;
+        }
+    }
+}
+
+/*
+ * Invoked on each slice tick of a lane. If the running process is blocked and
+ * another process is waiting, it gives up the lane right away. If the running
+ * process still has ticks left in its quantum it continues. Otherwise the policy
+ * is told its quantum has expired, and the process is stopped and put back on a
+ * queue, and the next process is dispatched; unless the policy lets it keep the
+ * lane, or no other process is waiting for one.
+ */
+static void on_tick(Lane *ln) {
+
+    Process *pr = ln->running;
+    Lane *target = ln;
+    int rerun, ticks;
+    char buffer[256];
+
+    if (pr == NULL || pr_status(pr) != ALIVE)
+        return;
+    if (mem_limit != 0UL)
+        poll_rss(pr);
+    /* Blocked, hand the rest of the slice to someone who can use it */
+    if (is_blocked(pr) && (lane_size(ln) > 0L || steal(ln, NULL))) {
+        block(ln);
+        return;
+    }
+    if (decr_tick(pr))
+        return;
+
+    /* Gather CPU info for the quantum that just ended, then ask the policy */
+    if (sample_cpu)
+        poll_cpu(pr);
+    ticks = pr_ticks(pr);
+    rerun = (*policy->on_tick)(ln->queue, pr);
+    if (pr_ticks(pr) != ticks)
+        trace_event(T_QUANTUM, pr, ln);
+
+    /* Nothing else to run, let the process carry on */
+    if (rerun || (lane_size(ln) == 0L && !steal(ln, NULL))) {
+        trace_event(T_CONTINUE, pr, ln);
+        if (!quiet)
+            report(pr, R_RUN);
+        return;
+    }
+
+    send_signal(pr, SIGSTOP);
+    trace_event(T_STOP, pr, ln);
+    /* Report process information */
+    if (!quiet)
+        report(pr, R_STOP);
+    ln->running = NULL;
+
+    /* Requeue on this lane, unless another lane's queue is much shorter */
+    if (lane_size(shortest_lane()) + 1 < lane_size(ln))
+        target = shortest_lane();
+    if (!lane_insert(target, pr)) {
+        p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+        print_error(buffer);
+    }
+
+    dispatch(ln);
+}
+
+/*
+ * Fills in a periodic timer value of one slice.
+ */
+static void slice_timer(struct itimerspec *timer) {
+
+    timer->it_value.tv_sec = (slice / 1000000);
+    timer->it_value.tv_nsec = ((slice * 1000L) % 1000000000L);
+    timer->it_interval = timer->it_value;
+}
+
+/*
+ * Adds the time since the lane's last tick (or since its timer was armed) to
+ * the measured slices; expirations beyond the first were missed, and are
+ * counted as such.
+ */
+static void measure_slice(Lane *ln, uint64_t expirations) {
+
+    unsigned long long now = sched_now(), len;
+
+    if (ln->ticked != 0ULL) {
+        len = now - ln->ticked;
+        if (slice_count == 0L || len < slice_min)
+            slice_min = len;
+        if (len > slice_max)
+            slice_max = len;
+        slice_sum += len;
+        slice_count++;
+    }
+    if (expirations > 1)
+        slice_missed += expirations - 1;
+    ln->ticked = now;
+}
+
+/*
+ * Prints the number of slice ticks, the slice asked for, and the mean, minimum
+ * and maximum time (in us) measured between ticks; printed even when quiet.
+ */
+static void print_slices(void) {
+
+    char buffer[32];
+
+    if (slice_count == 0L)
+        return;
+
+    p1putstr(notes_fd, "Slices: ");
+    p1ltoa(slice_count, buffer);
+    p1putstr(notes_fd, buffer);
+    p1putstr(notes_fd, " of ");
+    p1putint(notes_fd, slice);
+    p1putstr(notes_fd, " us, measured mean ");
+    p1ltoa((long)(slice_sum / slice_count / 1000ULL), buffer);
+    p1putstr(notes_fd, buffer);
+    p1putstr(notes_fd, " us, min ");
+    p1ltoa((long)(slice_min / 1000ULL), buffer);
+    p1putstr(notes_fd, buffer);
+    p1putstr(notes_fd, " us, max ");
+    p1ltoa((long)(slice_max / 1000ULL), buffer);
+    p1putstr(notes_fd, buffer);
+    p1putstr(notes_fd, " us, ");
+    p1ltoa((long)slice_missed, buffer);
+    p1putstr(notes_fd, buffer);
+    p1putstr(notes_fd, " missed\n");
+}
+
+/*
+ * Reads the state of the process from /proc/<pid>/stat. Returns 1 if it is
+ * sleeping ('S') or in uninterruptible wait ('D'), 0 if it is in any other state
+ * or cannot be sampled.
+ */
+static int is_blocked(Process *pr) {
+
+    Sampler *sm = (Sampler *)pm_get(samplers, pr_pid(pr));
+    ProcStat st;
+
+    if (sm == NULL || !sm_stat(sm, &st))
+        return 0;
+
+    return (st.state == 'S' || st.state == 'D');
+}
+
+/*
+ * Samples the resident memory of the process's job, keeping the total over the
+ * started jobs and its peak. Left as it was if the job cannot be sampled.
+ */
+static void poll_rss(Process *pr) {
+
+    Sampler *sm = (Sampler *)pm_get(samplers, pr_pid(pr));
+    ProcStat st;
+
+    if (sm == NULL || !sm_stat(sm, &st))
+        return;
+
+    resident = resident - pr_rss(pr) + st.rss * page_size;
+    pr_poll_rss(pr, st.rss * page_size);
+    if (resident > resident_peak)
+        resident_peak = resident;
+    if (pr_rss(pr) > job_peak)
+        job_peak = pr_rss(pr);
+}
+
+/*
+ * Returns 1 if starting another job could take the started jobs past MEM_NEAR
+ * percent of the --mem-limit=, in which case no more are started. The running
+ * and blocked jobs are sampled first, since the others are stopped and do not
+ * grow; the job to start is assumed to be as large as the largest seen so far.
+ * A job started less than MEM_SETTLE ms (or a slice) ago has not been sampled at
+ * its full size yet, so no other is started until then. One job is always
+ * allowed to run, so that a job larger than the limit does not stall the
+ * workload.
+ */
+static int mem_pressure(void) {
+
+    unsigned long long settle = MEM_SETTLE * 1000000ULL;
+    Process *pr;
+    long n;
+    int i;
+
+    if (mem_limit == 0UL || started_jobs == 0L)
+        return 0;
+
+    if (settle < slice * 1000ULL)
+        settle = slice * 1000ULL;
+    if (sched_now() - last_start < settle)
+        return 1;
+
+    for (i = 0; i < nlanes; i++)
+        if (lanes[i].running != NULL && pr_status(lanes[i].running) == ALIVE)
+            poll_rss(lanes[i].running);
+    for (n = cl_size(blocked); n > 0L; n--) {
+        cl_head(blocked, (void **)&pr);
+        if (pr_status(pr) == ALIVE)
+            poll_rss(pr);
+        cl_rotate(blocked);
+    }
+
+    return (resident + job_peak >= mem_limit / 100UL * MEM_NEAR);
+}
+
+/*
+ * Queues the processes deferred by dispatch() on the lanes with the fewest
+ * processes waiting, once memory is no longer short. They are checked again
+ * when dispatched, so a job that is started in the meantime defers them again.
+ */
+static void release_deferred(void) {
+
+    Process *pr;
+    char buffer[256];
+
+    while (!cl_isEmpty(deferred) && !mem_pressure()) {
+        cl_remove(deferred, (void **)&pr);
+        if (!lane_insert(shortest_lane(), pr)) {
+            free_pr(pr);
+            p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+            print_error(buffer);
+        }
+    }
+}
+
+/*
+ * Prints the peak resident memory of the started jobs, against --mem-limit=,
+ * and how many times a job was held back from starting.
+ */
+static void print_memory(void) {
+
+    char buffer[32];
+
+    if (mem_limit == 0UL)
+        return;
+
+    p1putstr(notes_fd, "Memory: peak ");
+    p1ltoa((long)(resident_peak >> 20), buffer);
+    p1putstr(notes_fd, buffer);
+    p1putstr(notes_fd, " MB resident of ");
+    p1ltoa((long)(mem_limit >> 20), buffer);
+    p1putstr(notes_fd, buffer);
+    p1putstr(notes_fd, " MB, ");
+    p1ltoa(deferrals, buffer);
+    p1putstr(notes_fd, buffer);
+    p1putstr(notes_fd, " starts deferred\n");
+}
+
+/*
+ * Takes the lane's running process, which is blocked, off the lane and puts it
+ * into the blocked set; it is left running, so that it can finish its wait. A
+ * stopped process cannot, and /proc cannot tell whether the wait of a stopped
+ * one is over. The blocked set is checked every BLOCK_POLL_US instead of every
+ * slice, so that once its wait is over the process runs alongside the lane's
+ * next process for no longer than that before it is stopped. The policy is told
+ * that it blocked, and the next process is dispatched.
+ */
+static void block(Lane *ln) {
+
+    struct itimerspec timer;
+    Process *pr = ln->running;
+    char buffer[256];
+
+    /* Gather CPU info for the part of the slice it ran, tell the policy */
+    if (sample_cpu)
+        poll_cpu(pr);
+    if (policy->on_block != NULL)
+        (*policy->on_block)(ln->queue, pr);
+    assign_home(pr, (int)(ln - lanes));
+    trace_event(T_BLOCK, pr, ln);
+    if (!quiet)
+        report(pr, R_BLOCK);
+    ln->running = NULL;
+
+    /* Start checking the blocked set if it was empty, at most a slice apart */
+    if (cl_isEmpty(blocked)) {
+        slice_timer(&timer);
+        if (slice > BLOCK_POLL_US) {
+            timer.it_value.tv_sec = 0L;
+            timer.it_value.tv_nsec = BLOCK_POLL_US * 1000L;
+            timer.it_interval = timer.it_value;
+        }
+        timerfd_settime(block_timer_fd, 0, &timer, NULL);
+    }
+    if (!cl_insert(blocked, pr)) {
+        p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+        print_error(buffer);
+    }
+
+    dispatch(ln);
+}
+
+/*
+ * Goes through the blocked set once. Processes that can run again are stopped
+ * and queued on the lane with the fewest processes waiting; finished processes
+ * are dropped. Stops checking once the set is empty.
+ */
+static void wake_blocked(void) {
+
+    struct itimerspec timer;
+    Process *pr;
+    long n;
+    char buffer[256];
+
+    for (n = cl_size(blocked); n > 0L; n--) {
+        cl_remove(blocked, (void **)&pr);
+        if (pr_status(pr) == DEAD) {
+            /* Finished while blocked, drop it; the policy is told on the lane it blocked on */
+            if (policy->on_exit != NULL)
+                (*policy->on_exit)(lanes[pr_home(pr)].queue, pr);
+            free_pr(pr);
+            continue;
+        }
+        /* Its memory may still grow while it waits */
+        if (mem_limit != 0UL)
+            poll_rss(pr);
+        if (is_blocked(pr)) {
+            /* Still waiting, check it again next time */
+            if (!cl_insert(blocked, pr)) {
+                p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+                print_error(buffer);
+            }
+            continue;
+        }
+        /* Runnable, stop it until it is dispatched again */
+        send_signal(pr, SIGSTOP);
+        if (!lane_insert(shortest_lane(), pr)) {
+            p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+            print_error(buffer);
+        }
+        trace_event(T_WAKE, pr, NULL);
+    }
+
+    /* Nothing left to check, stop the timer */
+    if (cl_isEmpty(blocked)) {
+        timer.it_value.tv_sec = timer.it_value.tv_nsec = 0L;
+        timerfd_settime(block_timer_fd, 0, &timer, NULL);
     }
+}
 
-    /* Assert that the quantum is not less than minimum allowed */
-    quantum = p1atoi(qu_str);
-    if (quantum < MIN_QUANTUM) {
-        p1putstr(STDOUT_FILENO, "The specified quantum is less than the minimum (");
-        p1putint(STDOUT_FILENO, MIN_QUANTUM);
-        p1putstr(STDOUT_FILENO, "), setting to minimum.\n");
-        quantum = MIN_QUANTUM;
-    }
+/*
+ * Starts or resumes the next process in the lane's queue by sending it SIGCONT,
+ * stealing one from another lane if the queue is empty. The process is pinned
+ * to the lane's CPU first if it last ran elsewhere. A process that hasn't started
+ * yet stopped itself right after fork(); it is waited on with WUNTRACED first,
+ * which returns at once unless the child has not reached its SIGSTOP yet, so that
+ * the SIGCONT cannot arrive too early. Finished processes are dropped from the
+ * queue. The slice timer is re-armed on each dispatch, so that every process
+ * receives whole ticks, and disarmed if the lane goes idle.
+ */
+static void dispatch(Lane *ln) {
 
-    /* Assert that the quantum does not exceed maximum allowed */
-    if (quantum > MAX_QUANTUM) {
-        p1putstr(STDOUT_FILENO, "The specified quantum is greater than the maximum (");
-        p1putint(STDOUT_FILENO, MAX_QUANTUM);
-        p1putstr(STDOUT_FILENO, "), setting to maximum.\n");
-        quantum = MAX_QUANTUM;
-    }
+    struct itimerspec timer;
+    struct epoll_event ev;
+    cpu_set_t set;
+    Process *temp;
+    struct rusage ru;
+    Sampler *sampler;
+    int status, pidfd;
+    char buffer[256];
 
-    /* Round quantum to nearest 100, calculate ticks per time quantum */
-    quantum = (((quantum + 50) / 100) * 100);
-    nticks = (quantum / SLICE);
+    slice_timer(&timer);
 
-    /* If a file has been specified, attempt to open it */
-    if (file != NULL) {
-        if ((fd = open(file, O_RDONLY)) < 0) {
-            /* Failed to open file, print error and exit */
-            p1strcpy(buffer, "ERROR: Failed to open: ");
-            p1strcat(buffer, file);
-            print_error(buffer);
+    while (lane_remove(ln, &temp) || steal(ln, &temp)) {
+        switch (pr_status(temp)) {
+            /* Waiting to start, watch it through a pidfd */
+            case WAITING:
+                /* Memory is short, let the jobs already started finish first */
+                if (mem_pressure()) {
+                    if (!cl_insert(deferred, temp)) {
+                        p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+                        print_error(buffer);
+                    }
+                    deferrals++;
+                    continue;
+                }
+                if (wait4(pr_pid(temp), &status, WUNTRACED, &ru) == pr_pid(temp) &&
+                        (WIFEXITED(status) || WIFSIGNALED(status))) {
+                    /* Killed before it ever ran, reap it here */
+                    kill_process(pr_pid(temp), status, &ru);
+                    active_processes--;
+                    free_pr(temp);
+                    continue;
+                }
+                pidfd = -1;
+#ifdef SYS_pidfd_open
+                pidfd = syscall(SYS_pidfd_open, pr_pid(temp), 0);
+#endif
+                if (pidfd >= 0) {
+                    ev.events = EPOLLIN;
+                    ev.data.fd = pidfd;
+                    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pidfd, &ev);
+                    assign_pidfd(temp, pidfd);
+                }
+                /* Open its /proc files; without them it is not sampled */
+                if ((sampler = open_sampler(pr_pid(temp))) != NULL)
+                    pm_put(samplers, pr_pid(temp), sampler);
+                pr_wake(temp);
+                started_jobs++;
+                last_start = sched_now();
+                break;
+            /* Started already, resume it */
+            case ALIVE:
+                break;
+            /* Finished or died, drop it */
+            case DEAD:
+            default:
+                if (policy->on_exit != NULL)
+                    (*policy->on_exit)(ln->queue, temp);
+                free_pr(temp);
+                continue;
         }
-    }
 
-    /* Open the output file, creating it if it doesn't exist */
-    if (output_file != NULL) {
-        if ((output_fd = open(output_file, O_WRONLY | O_CREAT | O_TRUNC, S_IRWXU | S_IRWXG | S_IRWXO)) < 0) {
-            /* Failed to create/open output file, print error and exit */
-            p1strcpy(buffer, "ERROR: Failed to create/open: ");
-            p1strcat(buffer, output_file);
-            print_error(buffer);
+        /* Pin to this lane's CPU if it ran somewhere else last */
+        if (ln->cpu != -1 && pr_lane(temp) != ln->cpu) {
+            CPU_ZERO(&set);
+            CPU_SET(ln->cpu, &set);
+            sched_setaffinity(pr_pid(temp), sizeof(set), &set);
+            assign_lane(temp, ln->cpu);
         }
-    }
-
-    /* Load the queue with the processes, given the workload file */
-    load_processes(fd);
 
-    /* Get array of processes to fork from */
-    if ((prs = (Process **)cl_toArray(pr_list, &len)) == NULL) {
-        /* Allocation fails, print error and exit */
-        if (!cl_isEmpty(pr_list)) {
-            p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
-            print_error(buffer);
-        }
-    }
-    active_processes = len;
-
-    /*
-     * For each process in the queue:
-     *   Invoke fork(), obtain the PID
-     *   For the parent, assign the PID to the process
-     *   For the child, invoke execvp() on program
-     *   Otherwise, print error and exit
-     */
-    for (j = 0; j < len; j++) {
-        pid = fork();
-        if (pid == 0) {
-            /* The child waits here until SIGUSR1 is */
-            /* This portion was borrowed from the Piazza post on signal handling */
-            struct timespec timer = {0, 20000000};
-            while (!interrupted)
-                nanosleep(&timer, NULL);
-            /* Child process, invoke execvp() on program */
-            args = pr_argv(prs[j]);
-            execvp(args[0], args);
-            /* If this is reached, error occured invoking the program */
-            /* Print error message and exit */
-            p1strcpy(buffer, "ERROR: Failed to execute:");
-            for (i = 0; args[i] != NULL; i++) {
-                p1strcat(buffer, " ");
-                p1strcat(buffer, args[i]);
-            }
-            free(prs);
-            print_error(buffer);
-        } else if (pid > 0) {
-            /* Parent process, assign the PID and ticks per quantum */
-            assign_pid(prs[j], pid);
-            assign_ticks(prs[j], nticks);
-        } else {
-            /* Fork error, print error and exit */
-            p1strcpy(buffer, "ERROR: Previous call to fork() failed.");
-            print_error(buffer);
-        }
+        /* Gather CPU information before starting/resuming, send it SIGCONT */
+        if (sample_cpu)
+            poll_cpu(temp);
+        ln->running = temp;
+        assign_start(temp, sched_now());
+        trace_event(T_DISPATCH, temp, ln);
+        send_signal(temp, SIGCONT);
+        timerfd_settime(ln->timer_fd, 0, &timer, NULL);
+        ln->ticked = sched_now();
+        return;
     }
-    /* Array not needed at this point, free it */
-    free(prs);
 
-    /* Sets the timer structs members */
-    timer.it_value.tv_sec = (SLICE / 1000);
-    timer.it_value.tv_usec = ((SLICE * 1000) % 1000000);
-    timer.it_interval = timer.it_value;
+    /* Nothing left to run, stop the lane's timer */
+    timer.it_value.tv_sec = timer.it_value.tv_nsec = 0L;
+    timerfd_settime(ln->timer_fd, 0, &timer, NULL);
+}
 
-    /* Timer is to run in real time, sends SIGALRM at each expiration */
-    if ((setitimer(ITIMER_REAL, &timer, NULL)) == -1) {
-        /* Timer set failed, kill all child processes */
-        while (cl_remove(pr_list, (void **)&temp)) {
-            kill(pr_pid(temp), SIGKILL);
-            free_pr(temp);
-        }
-        /* Print error and exit */
-        p1strcpy(buffer, "ERROR: Failed to create the quantum timer.");
-        print_error(buffer);
+/*
+ * Moves a waiting process from the lane with the longest queue over to 'ln', and
+ * stores it into '*pr' if 'pr' is not NULL (in which case it is not queued on
+ * 'ln'). Returns 1 if a process was moved, 0 if every other queue is empty.
+ */
+static int steal(Lane *ln, Process **pr) {
+
+    Lane *victim = NULL;
+    Process *temp;
+    int i;
+
+    /* Find the lane with the most processes waiting */
+    for (i = 0; i < nlanes; i++)
+        if (&lanes[i] != ln && lane_size(&lanes[i]) > 0L &&
+                (victim == NULL || lane_size(&lanes[i]) > lane_size(victim)))
+            victim = &lanes[i];
+    if (victim == NULL)
+        return 0;
+
+    lane_remove(victim, &temp);
+    if (pr != NULL) {
+        *pr = temp;
+        return 1;
     }
 
-    /*
-     * The first process will immediately halt, due to SIGALRM handler being
-     * invoked. This means the second is the first to execute. To fix this,
-     * rotate the list size()-1 times such that the last process is halted
-     * immediately, and the first process will be the first to execute.
-     */
-    for (j = 0L; j < cl_size(pr_list) - 1; j++)
-        cl_rotate(pr_list);
+    return lane_insert(ln, temp);
+}
 
-    /* Parent process pauses, waits for all child processes to complete */
-    sigalrm_handler(SIGALRM);
-    while (active_processes > 0L)
-        pause();
+/*
+ * Returns the lane with the fewest processes waiting.
+ */
+static Lane *shortest_lane(void) {
 
-    /* Free all allocated memory */
-    free_mem();
+    Lane *ln = &lanes[0];
+    int i;
 
-    return 0;
+    for (i = 1; i < nlanes; i++)
+        if (lane_size(&lanes[i]) < lane_size(ln))
+            ln = &lanes[i];
+
+    return ln;
 }
 
 /*
- * Populates the process list with process instances given a file descriptor of
- * the work file to read from. Reads each line, creates a process struct from the
- * line, and adds it into the queue. Closes the descriptor when its done.
+ * Returns the number of processes waiting on the lane's queue.
  */
-static void load_processes(int fd) {
+static long lane_size(Lane *ln) {
 
-    Process *pr;
-    char buffer[4096], word[1024];
-    int len;
+    return (*policy->size)(ln->queue);
+}
 
-    while (p1getline(fd, buffer, sizeof(buffer)) > 0) {
+/*
+ * Queues the process on the lane, in the order chosen by the policy. Returns 1
+ * if successful, 0 if not (allocation failed).
+ */
+static int lane_insert(Lane *ln, Process *pr) {
 
-        /* Ignores blank lines */
-        p1getword(buffer, 0, word);
-        if (p1strneq(word, "\n", 1))
-            continue;
-        
-        /* Trim off newline */
-        len = p1strlen(buffer);
-        if (buffer[len - 1] == '\n')
-            buffer[len - 1] = '\0';
-
-        /* Creates the process from the given line */
-        pr = malloc_pr(buffer);
-        if (pr == NULL) {
-            /* Allocation failed, print error and exit */
-            if (fd != STDIN_FILENO)
-                close(fd);
-            p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory");
-            print_error(buffer);
-        }
+    return (*policy->enqueue)(ln->queue, pr);
+}
 
-        /* Insert the new struct instance into list */
-        if (!cl_insert(pr_list, pr)) {
-            /* Insertion failed, print error and exit */
-            if (fd != STDIN_FILENO)
-                close(fd);
-            free_pr(pr);
-            p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory");
-            print_error(buffer);
-        }
-    }
+/*
+ * Takes the next process to run off the lane's queue, stores it into '*pr'.
+ * Returns 1 if successful, 0 if the queue is empty.
+ */
+static int lane_remove(Lane *ln, Process **pr) {
 
-    /* File no longer needed, close it */
-    if (fd != STDIN_FILENO)
-        close(fd);
+    return (*policy->pick_next)(ln->queue, pr);
 }
 
 /*
- * Kills the child process with the specified PID. Sets its status
- * to DEAD, such that, it will be removed from the queue when its next
- * selected by the scheduler to run.
+ * Admission control for the deadline set. Taking the processes in deadline
+ * order, the estimated runtimes due by each deadline must fit into the time
+ * available on all lanes by then, and each must fit by its own deadline alone,
+ * since a process only runs on one lane at a time; so the longest runtime due by
+ * a deadline fits too. EDF meets every deadline of
+ * a set that passes on a single lane; with several lanes the test is only an
+ * optimistic bound, as it assumes the work splits evenly across them. A warning
+ * is printed for each deadline that cannot be met, and for processes with a
+ * deadline but no runtime estimate, which are not counted. Nothing is rejected.
  */
-static void kill_process(pid_t pid) {
+static void check_deadlines(void) {
 
-    long i, len = 0L;
-    Process **plist = NULL;
+    Heap *hp;
+    Process *pr, **prs;
+    unsigned long long due = 0ULL;
+    long i, len = 0L, unknown = 0L;
+    char buffer[4096], num[32];
 
-    /* Get current array of processes to iterate through */
-    if ((plist = (Process **)cl_toArray(pr_list, &len)) == NULL)
-        return;
+    if ((prs = (Process **)cl_toArray(pr_list, &len)) == NULL) {
+        if (cl_isEmpty(pr_list))
+            return;
+        p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+        print_error(buffer);
+    }
+    if ((hp = hp_create(edf_compare)) == NULL) {
+        free(prs);
+        p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+        print_error(buffer);
+    }
 
-    /* Iterates through array, finds the child process */
+    /* Sort the processes that have deadlines */
     for (i = 0L; i < len; i++) {
-        if (pr_pid(plist[i]) == pid) {
-            /* Process found, sets its status to DEAD */
-            pr_kill(plist[i]);
-            break;
+        if (pr_deadline(prs[i]) != 0L && !hp_insert(hp, prs[i])) {
+            free(prs);
+            hp_destroy(hp, NULL);
+            p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+            print_error(buffer);
+        }
+    }
+    free(prs);
+
+    while (hp_remove(hp, (void **)&pr)) {
+        if (pr_runtime(pr) == 0L) {
+            unknown++;
+            continue;
+        }
+        due += pr_runtime(pr);
+        if (pr_runtime(pr) <= pr_deadline(pr) && due <= (unsigned long long)pr_deadline(pr) * nlanes)
+            continue;
+        p1strcpy(buffer, "WARNING: Infeasible deadline of ");
+        p1ltoa(pr_deadline(pr), num);
+        p1strcat(buffer, num);
+        if (pr_runtime(pr) > pr_deadline(pr)) {
+            /* The process cannot finish by its deadline even running alone */
+            p1strcat(buffer, " ms; the process needs ");
+            p1ltoa(pr_runtime(pr), num);
+            p1strcat(buffer, num);
+            p1strcat(buffer, " ms by itself:");
+        } else {
+            /* Too much work is due by this deadline, even split evenly over the lanes */
+            p1strcat(buffer, " ms; ");
+            p1ltoa(due, num);
+            p1strcat(buffer, num);
+            p1strcat(buffer, " ms of work is due by then");
+            if (nlanes > 1) {
+                p1strcat(buffer, " (an optimistic bound over ");
+                p1ltoa(nlanes, num);
+                p1strcat(buffer, num);
+                p1strcat(buffer, " lanes)");
+            }
+            p1strcat(buffer, ":");
+        }
+        for (i = 0L; pr_argv(pr)[i] != NULL; i++) {
+            p1strcat(buffer, " ");
+            p1strcat(buffer, pr_argv(pr)[i]);
         }
+        p1strcat(buffer, "\n");
+        p1putstr(notes_fd, buffer);
     }
+    hp_destroy(hp, NULL);
 
-    /* Free array when done */
-    free(plist);
+    if (unknown > 0L) {
+        p1putstr(notes_fd, "WARNING: ");
+        p1putint(notes_fd, (int)unknown);
+        p1putstr(notes_fd, " process(es) with a deadline but no runtime estimate were not checked.\n");
+    }
 }
 
 /*
- * SIGUSR1 handler; increments the interrupted variable, wakes the child process up.
+ * Records whether the process, which just finished, met its deadline. A line is
+ * kept for each miss, to be printed in the report at exit.
  */
-static void sigusr1_handler(UNUSED int signo) {
+static void record_deadline(Process *pr) {
+
+    unsigned long finished;
+    long i;
+    char buffer[4096], num[32];
+    char *line;
+
+    if (pr_deadline(pr) == 0L)
+        return;
 
-    interrupted++;
+    finished = (unsigned long)((sched_now() - start_time) / 1000000ULL);
+    if (finished <= pr_deadline(pr)) {
+        deadlines_met++;
+        return;
+    }
+    deadlines_missed++;
+
+    /* Describe the miss */
+    p1itoa((int)pr_pid(pr), num);
+    p1strcpy(buffer, num);
+    p1strcat(buffer, " missed its deadline of ");
+    p1ltoa(pr_deadline(pr), num);
+    p1strcat(buffer, num);
+    p1strcat(buffer, " ms by ");
+    p1ltoa(finished - pr_deadline(pr), num);
+    p1strcat(buffer, num);
+    p1strcat(buffer, " ms:");
+    for (i = 0L; pr_argv(pr)[i] != NULL; i++) {
+        p1strcat(buffer, " ");
+        p1strcat(buffer, pr_argv(pr)[i]);
+    }
+    if ((line = p1strdup(buffer)) != NULL && !cl_insert(missed_list, line))
+        free(line);
 }
 
 /*
- * SIGUSR2 handler; does nothing.
+ * Prints how many processes met and missed their deadlines, followed by a line
+ * for each miss. Printed even when quiet, nothing is printed without deadlines.
  */
-static void sigusr2_handler(UNUSED int signo) {}
+static void print_deadlines(void) {
 
-/*
- * SIGCHLD handler; kills the child process so that it can be removed from the queue later
- * on. Also wakes up parent process from pause(), checks remaining processes left.
- */
-static void sigchld_handler(UNUSED int signo) {
+    char *line;
 
-    pid_t pid;
-    int status;
+    if (deadlines_met + deadlines_missed == 0L)
+        return;
 
-    /* This section was borrowed from the LPE book, section 8.4.6 */
-    /* Decrement the number of active processes and wake up the parent process's pause() */
-    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
-        if (WIFEXITED(status) || WIFSIGNALED(status)) {
-            kill_process(pid);
-            active_processes--;
-            kill(parent_pid, SIGUSR2);
-        }
+    p1putstr(notes_fd, "Deadlines: ");
+    p1putint(notes_fd, (int)deadlines_met);
+    p1putstr(notes_fd, " met, ");
+    p1putint(notes_fd, (int)deadlines_missed);
+    p1putstr(notes_fd, " missed\n");
+    while (cl_remove(missed_list, (void **)&line)) {
+        p1putstr(notes_fd, "  ");
+        p1putstr(notes_fd, line);
+        p1putstr(notes_fd, "\n");
+        free(line);
     }
 }
 
 /*
- * SIGALRM handler; when the timer expires, selects the next process in the queue to
- * run.
+ * Sends the signal to the job led by the process: to its process group, and to
+ * the process alone (through its pidfd if one is held) if the group is gone. A
+ * job with a cgroup is also thawed before it is continued, and frozen once it is
+ * stopped.
  */
-static void sigalrm_handler(UNUSED int signo) {
+static void send_signal(Process *pr, int signo) {
 
-    Process *temp;
+    if (signo == SIGCONT && pr_freezer(pr) != -1)
+        (void)write(pr_freezer(pr), "0", 1);
 
-    /*
-     * First, check to see if there are ticks left in the time
-     * quantum. If so, allow process to continue running. Otherwise,
-     * send SIGSTOP to the child process.
-     */
-    if (!cl_head(pr_list, (void **)&temp))
-        return;
-    if (pr_status(temp) == ALIVE) {
-        if (decr_tick(temp))
-            return;
-        kill(pr_pid(temp), SIGSTOP);
-        if (!quiet) {
-            /* Gather CPU info, print process information */
-            poll_cpu(temp);
-            print(temp);
-        }
+    if (kill(-pr_pid(pr), signo) == -1) {
+#ifdef SYS_pidfd_send_signal
+        if (pr_pidfd(pr) == -1 ||
+                syscall(SYS_pidfd_send_signal, pr_pidfd(pr), signo, NULL, 0) == -1)
+#endif
+            kill(pr_pid(pr), signo);
     }
 
-    /* Rotate list to get the next process */
-    cl_rotate(pr_list);
+    if (signo == SIGSTOP && pr_freezer(pr) != -1)
+        (void)write(pr_freezer(pr), "1", 1);
+}
 
-    /*
-     * Now, check the status of the next process. If it hasn't
-     * started yet, send it a SIGUSR1 signal. If it has, send it
-     * a SIGCONT signal. Otherwise, it is assumed to have finished,
-     * so remove it from the queue.
-     */
-    while (cl_head(pr_list, (void **)&temp)) {
-        /* Gather CPU information before starting/resuming */
-        if (!quiet)
-            poll_cpu(temp);
-        switch (pr_status(temp)) {
-            /* Waiting to start, send it SIGUSR1 signal */
-            case WAITING:
-                pr_wake(temp);
-                kill(pr_pid(temp), SIGUSR1);
-                return;
-            /* Started already, send it SIGCONT signal */
-            case ALIVE:
-                kill(pr_pid(temp), SIGCONT);
-                return;
-            /* Finished or died, remove from queue */
-            case DEAD:
-            default:
-                cl_remove(pr_list, (void **)&temp);
-                free_pr(temp);
-        }
-    }
+/*
+ * Kills the job led by the process. SIGKILL ends a stopped job too; a frozen
+ * cgroup is thawed as well, so that the job does not linger until it is.
+ */
+static void kill_job(Process *pr) {
+
+    send_signal(pr, SIGKILL);
+    send_signal(pr, SIGCONT);
 }
 
 /*
@@ -635,283 +2592,276 @@ static void pages_to_bytes(char *buff) {
 }
 
 /*
- * Extracts information from /proc/stat and /proc/<pid>/stat, and stores
- * it into the specified process instance. Invoked before and after the
- * child process runs, so that the CPU utilization may be calculated.
+ * Samples the CPU time the child process has used so far, and stores it into
+ * the process instance with the time of the sample. Invoked before and after
+ * the child process runs, so that the CPU utilization may be calculated.
  */
 static void poll_cpu(Process *pr) {
 
-    int i, index;
-    int cpu_fd = -1, stat_fd = -1;
-    unsigned long jiffies = 0L;
-    unsigned long util = 0L;
-    char pid_str[32], utime[32], stime[32], cutime[32], cstime[32];
-    char buffer[4096], word[1024];
-
-    /* Open /proc/stat */
-    if ((cpu_fd = open("/proc/stat", O_RDONLY)) < 0)
-        goto close_files;
-    p1getline(cpu_fd, buffer, sizeof(buffer));
-    index = 0;
-    /* Get first line, contains cumulative jiffies of CPU usage */
-    while ((index = p1getword(buffer, index, word)) != -1) {
-        if (p1strneq(word, "\n", 1) || p1strneq(word, "cpu", 3))
-            continue;
-        /* Combine each column into one value */
-        jiffies += p1atol(word);
+    Sampler *sm = (Sampler *)pm_get(samplers, pr_pid(pr));
+    unsigned long long cputime;
+
+    if (sm != NULL && sm_cputime(sm, &cputime))
+        pr_poll_cpu(pr, sched_now(), cputime);
+}
+
+/*
+ * Records the event in the trace, with the lane it happened on (if any), when
+ * tracing is enabled.
+ */
+static void trace_event(TraceType type, Process *pr, Lane *ln) {
+
+    if (trace != NULL)
+        tr_record(trace, type, pr_pid(pr), (ln != NULL) ? (int)(ln - lanes) : -1, pr_ticks(pr));
+}
+
+/*
+ * Pushes a record of the event onto the ring for the reporter thread; if the
+ * reporter has fallen too far behind, the record is dropped instead of waiting.
+ * An exit is never dropped, since the reporter only closes the process's /proc
+ * files on its exit; it is held back instead, along with any exit after it, and
+ * pushed once there is room. The I/O amount is still sampled here, since the
+ * adaptive policy sizes the quantum with it.
+ */
+static void report(Process *pr, Event event) {
+
+    Sampler *sm = (Sampler *)pm_get(samplers, pr_pid(pr));
+    Report rp, *late;
+    ProcIO io;
+    char buffer[256];
+
+    if (event != R_EXIT && sm != NULL && sm_io(sm, &io))
+        pr_poll_io(pr, io.rchar + io.wchar + io.syscr + io.syscw + io.read_bytes + io.write_bytes);
+
+    rp.pid = pr_pid(pr);
+    rp.event = event;
+    rp.cpu = pr_cpu(pr);
+    rp.cputime = pr_cputime(pr);
+    rp.when = sched_now();
+
+    push_late_exits();
+    if (event != R_EXIT || (cl_isEmpty(late_exits) && !rg_full(reports))) {
+        rg_push(reports, &rp);
+        return;
+    }
+    if ((late = (Report *)malloc(sizeof(Report))) == NULL || !cl_insert(late_exits, late)) {
+        free(late);
+        p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+        print_error(buffer);
     }
-    close(cpu_fd);
-    cpu_fd = -1;
+    *late = rp;
+}
 
-    /* Opens /proc/<pid>/stat file */
-    p1itoa((int)pr_pid(pr), pid_str);
-    p1strcpy(buffer, "/proc/");
-    p1strcat(buffer, pid_str);
-    p1strcat(buffer, "/stat");
-    if ((stat_fd = open(buffer, O_RDONLY)) < 0)
-        goto close_files;
-
-    /* Obtain the CPU time to calculate CPU utilization */
-    p1getline(stat_fd, buffer, sizeof(buffer));
-    i = 1;
-    index = 0;
-    while ((index = p1getword(buffer, index, word)) != -1) {
-        switch (i) {
-            /* CPU time spent in user code */
-            case 14:
-                p1strcpy(utime, word);
-                break;
-            /* CPU time spent in kernel code */
-            case 15:
-                p1strcpy(stime, word);
-                break;
-            /* Same as utime, but includes children */
-            case 16:
-                p1strcpy(cutime, word);
-                break;
-            /* Same as stime, but includes children */
-            case 17:
-                p1strcpy(cstime, word);
-                break;
-            /* All other info useless, skip it */
-            default:
-                break;
-        }
-        i++;
+/*
+ * Pushes the exits held back by report(), oldest first, until the ring is full
+ * again or none are left.
+ */
+static void push_late_exits(void) {
+
+    Report *late;
+
+    while (!cl_isEmpty(late_exits) && !rg_full(reports)) {
+        cl_remove(late_exits, (void **)&late);
+        rg_push(reports, late);
+        free(late);
     }
-    close(stat_fd);
-    stat_fd = -1;
+}
+
+/*
+ * Creates the ring and the report's writer, starts the report with the CSV
+ * header or binary header if needed, and starts the reporter thread. Jobs are
+ * still forked by admit() while it runs, and a child only has a copy of the
+ * calling thread, so a lock the reporter held at the time stays held in the
+ * child for good. This is safe only because the child calls nothing but
+ * async-signal-safe functions until it execs, none of which take a lock.
+ */
+static void start_reporter(void) {
 
-    /* Stores the relevant information into the process */
-    util = p1atol(utime) + p1atol(stime) + p1atol(cutime) + p1atol(cstime);
-    pr_poll_jiffies(pr, jiffies);
-    pr_poll_util(pr, util);
-    return;
+    RecHeader header;
+    PidMap *sampled;
+    char buffer[256];
 
-close_files:
-    /* Close any open files and return */
-    if (cpu_fd != -1)
-        close(cpu_fd);
-    if (stat_fd != -1)
-        close(stat_fd);
-    return;
+    atomic_store(&reporter_done, 0);
+    if ((reports = rg_create(MAX_REPORTS, sizeof(Report))) == NULL ||
+            (late_exits = cl_create()) == NULL ||
+            (sampled = pm_create(active_processes)) == NULL ||
+            (report_out = p1wopen(output_fd)) == NULL) {
+        p1strcpy(buffer, "ERROR: Failed to allocate sufficient amount of memory.");
+        print_error(buffer);
+    }
+    if (format == F_CSV) {
+        p1wputstr(report_out, CSV_HEADER);
+    } else if (format == F_BINARY) {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, REC_MAGIC, sizeof(header.magic));
+        header.size = sizeof(Record);
+        header.clk_tck = (uint32_t)sysconf(_SC_CLK_TCK);
+        p1wwrite(report_out, &header, sizeof(header));
+    }
+    if (pthread_create(&reporter, NULL, run_reporter, sampled) != 0) {
+        p1strcpy(buffer, "ERROR: Failed to start the reporter thread.");
+        print_error(buffer);
+    }
+    reporter_running = 1;
 }
 
 /*
- * Re-configures the process's quantum slice, given the amount of
- * I/O work it has previously performed. Depending on its I/O work
- * compared to the workload's average I/O, the process will receive
- * extra ticks, or have some ticks revoked.
- *
- * The design is simple: First calculate the ratio of the process's
- * I/O work done to the workload's I/O. If the ratio falls within a
- * defined mid-range, no changes are made to the number of ticks per
- * time quantum. Otherwise, if the ratio falls below a limit, ticks
- * are added; likewise, a higher I/O ratio will cause the process to
- * lose ticks.
- */
-#define TIER1 0.2F      /* The % of ticks to add/revoke for first check */
-#define TIER2 0.35F     /* The % of ticks to add/revoke for second check */
-#define TIER3 0.5F      /* The % of ticks to add/revoke for final check */
-static void adjust_quantum(Process *pr, unsigned long n_io) {
-
-    static unsigned long avg_io = 0L;
-    static short first = 0;
-    float ratio = 1.0F;
-    int ticks = (quantum / SLICE), n_ticks = ticks;
-
-    /* First I/O read, add twice to get accurate average */
-    if (!first) {
-        avg_io += n_io;
-        first++;
-    }
-
-    /* Calculate average I/O and process's ratio */
-    avg_io += n_io;
-    avg_io /= 2;
-    ratio = ((float)n_io / avg_io);
-    /* Ratio is somewhat normal, return with no changes */
-    if (0.75F <= ratio && ratio <= 1.25F)
-        return;
+ * Pushes the exits still held back, waiting for the reporter to make room,
+ * then tells the reporter thread to stop once the ring is empty, waits for it,
+ * and destroys the ring and the writer, flushing the rest of the report. Notes
+ * how many records were dropped, if any.
+ */
+static void stop_reporter(void) {
+
+    struct timespec nap;
+
+    if (reporter_running) {
+        nap.tv_sec = (REPORT_PERIOD / 1000);
+        nap.tv_nsec = ((REPORT_PERIOD * 1000000L) % 1000000000L);
+        for (push_late_exits(); !cl_isEmpty(late_exits); push_late_exits())
+            nanosleep(&nap, NULL);
+        atomic_store(&reporter_done, 1);
+        pthread_join(reporter, NULL);
+        reporter_running = 0;
+        if (rg_dropped(reports) > 0L) {
+            p1putint(notes_fd, (int)rg_dropped(reports));
+            p1putstr(notes_fd, " report(s) dropped, the reporter fell behind.\n");
+        }
+    }
+    p1wclose(report_out);
+    report_out = NULL;
+    rg_destroy(reports);
+    reports = NULL;
+    cl_destroy(late_exits, free);
+    late_exits = NULL;
+}
+
+/*
+ * Body of the reporter thread. It lowers its own priority so that it never
+ * competes with the event loop, then wakes every REPORT_PERIOD ms to print a line for
+ * each record pushed since, and flushes them in one write(). It keeps its own
+ * /proc samplers, since those of the event loop are closed as soon as a process
+ * is reaped, in the map passed as 'arg'; the map is created by start_reporter(),
+ * so that the thread reads nothing the event loop writes besides the ring.
+ */
+static void *run_reporter(void *arg) {
+
+    struct timespec nap;
+    PidMap *sampled = (PidMap *)arg;
+    Report rp;
+    int done;
+
+    setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), REPORTER_NICE);
+
+    nap.tv_sec = (REPORT_PERIOD / 1000);
+    nap.tv_nsec = ((REPORT_PERIOD * 1000000L) % 1000000000L);
+    do {
+        /* Read the flag first, so that no record pushed before it is missed */
+        done = atomic_load(&reporter_done);
+        while (rg_pop(reports, &rp))
+            print(&rp, sampled);
+        p1wflush(report_out);
+        if (!done)
+            nanosleep(&nap, NULL);
+    } while (!done);
+
+    pm_destroy(sampled, (void *)sm_close);
+    return NULL;
+}
 
-    if (ratio < 0.75F) {        /* Process is CPU-bound */
-        /* First check and tier increment */
-        if (0.5F <= ratio && ratio < 0.75F)
-            n_ticks += (int)(ticks * TIER1);
-        /* Second check and tier increment */
-        else if (0.25F <= ratio && ratio < 0.5F)
-            n_ticks += (int)(ticks * TIER2);
-        /* Final check and tier increment */
-        else
-            n_ticks += (int)(ticks * TIER3);
-    } else {    /* Process is I/O bound */
-        /* First check and tier decrement */
-        if (1.25F > ratio && ratio <= 1.5F)
-            n_ticks -= (int)(ticks * TIER1);
-        /* Second check and tier decrement */
-        else if (1.5F > ratio && ratio <= 1.75)
-            n_ticks -= (int)(ticks * TIER2);
-        /* Final check and tier decrement */
-        else
-            n_ticks -= (int)(ticks * TIER3);
+/*
+ * Prints out information on the reported process, sampled from the files
+ * within its /proc/<pid>/ directory, in the format selected. Runs on the
+ * reporter thread; the files are opened the first time the process is reported,
+ * and closed once it exits. Nothing is left to sample by then, so an exit is
+ * only reported in the structured formats, with the exact CPU time and the
+ * other counters zero.
+ */
+static void print(Report *rp, PidMap *sampled) {
+
+    Sampler *sm = (Sampler *)pm_get(sampled, rp->pid);
+    ProcStat st;
+    ProcIO io;
+
+    if (rp->event == R_EXIT) {
+        sm = (Sampler *)pm_remove(sampled, rp->pid);
+        if (format != F_TEXT) {
+            memset(&st, 0, sizeof(st));
+            memset(&io, 0, sizeof(io));
+            st.state = 'X';
+            if (format == F_BINARY)
+                print_binary(rp, &st, &io, (sm != NULL) ? sm_cmdline(sm) : "");
+            else
+                print_fields(rp, &st, &io, (sm != NULL) ? sm_cmdline(sm) : "");
+        }
+        sm_close(sm);
+        return;
     }
 
-    /* Assign process new quantum ticks */
-    assign_ticks(pr, n_ticks);
+    /* Open its files on first sight; the map was sized for every process */
+    if (sm == NULL && (sm = open_sampler(rp->pid)) != NULL)
+        pm_put(sampled, rp->pid, sm);
+
+    /* Sample the process, nothing to print if it is gone */
+    if (sm == NULL || !sm_io(sm, &io) || !sm_stat(sm, &st))
+        return;
+
+    switch (format) {
+        case F_CSV:
+        case F_JSONL:
+            print_fields(rp, &st, &io, sm_cmdline(sm));
+            break;
+        case F_BINARY:
+            print_binary(rp, &st, &io, sm_cmdline(sm));
+            break;
+        case F_TEXT:
+        default:
+            print_text(rp, &st, &io, sm_cmdline(sm));
+            break;
+    }
 }
 
 /*
- * Prints out information on the specified process by accesssing its files
- * from within the /proc/<pid>/ directory.
+ * Prints the process information as a row of the table, with the counters
+ * abbreviated to fit their columns.
  */
 #define LIMIT 20L       /* Prints the header after this many lines */
-static void print(Process *pr) {
+static void print_text(Report *rp, ProcStat *st, ProcIO *io, char *cmd) {
 
     static unsigned long iter = 0;
-    int i, index;
-    int cmd_fd = -1, io_fd = -1, stat_fd = -1;
-    unsigned long n_io = 0L;
     char pid_str[32], syscr[32], syscw[32], stat[32], flts[32],
-        usrtm[32], systm[32], vmsz[32], rssz[32], cpu[32], cmd[2048];
-    char res[4096], buffer[4096], word[1024];
+        usrtm[32], systm[32], vmsz[32], rssz[32], cpu[32];
+    char res[4096];
     char *res_ptr = NULL;
 
     /* Gather CPU utilization % */
-    p1itoa(pr_cpu(pr), cpu);
+    p1itoa(rp->cpu, cpu);
     p1strcat(cpu, "%");
-
-    /* Access the /proc/<pid>/cmdline file */
-    p1itoa((int)pr_pid(pr), pid_str);
-    p1strcpy(buffer, "/proc/");
-    p1strcat(buffer, pid_str);
-    p1strcat(buffer, "/cmdline");
-    if ((cmd_fd = open(buffer, O_RDONLY)) < 0)
-        goto close_files;
-
-    /* Store the cmd into a buffer for later */
-    p1getline(cmd_fd, cmd, sizeof(cmd));
-    i = 0;
-    while (1) {
-        if (cmd[i] == '\0') {
-            i++;
-            /* Extract all args from cmdline; replace terminating chars with space */
-            if (cmd[i] == '\0')
-                break;
-            cmd[--i] = ' ';
-        }
-        i++;
-    }
-    close(cmd_fd);
-    cmd_fd = -1;
-
-    /* Accesses the /proc/<pid>/io file */
-    p1strcpy(buffer, "/proc/");
-    p1strcat(buffer, pid_str);
-    p1strcat(buffer, "/io");
-    if ((io_fd = open(buffer, O_RDONLY)) < 0)
-        goto close_files;
-    i = 1;
-
-    /* Only want to extract the system read and write calls; need to skip some lines */
-    while (p1getline(io_fd, buffer, sizeof(buffer))) {
-        index = 0;
-        index = p1getword(buffer, index, word);
-        if (i == 3) {
-            /* On the 3rd line is the system read calls */
-            index = p1getword(buffer, index, syscr);
-            n_io += p1atol(syscr);
-            syscr[p1strlen(syscr)-1] = '\0';
-            compact_num(syscr);
-        } else if (i == 4) {
-            /* On the 4th line is the system write calls */
-            index = p1getword(buffer, index, syscw);
-            n_io += p1atol(syscw);
-            syscw[p1strlen(syscw)-1] = '\0';
-            compact_num(syscw);
-        } else if (i < 7) {
-            /* Add all other line values into total IO done */
-            index = p1getword(buffer, index, word);
-            n_io += p1atol(word);
-        }
-        i++;
-    }
-    close(io_fd);
-    io_fd = -1;
-
-    /* Accesses the /proc/<pid>/stat file */
-    p1strcpy(buffer, "/proc/");
-    p1strcat(buffer, pid_str);
-    p1strcat(buffer, "/stat");
-    if ((stat_fd = open(buffer, O_RDONLY)) < 0)
-        goto close_files;
-
-    /* All information is on one line; need to extract by word */
-    p1getline(stat_fd, buffer, sizeof(buffer));
-    i = 1;
-    index = 0;
-    while ((index = p1getword(buffer, index, word)) != -1) {
-        switch (i) {
-            /* Obtains the current status of the process */
-            case 3:
-                p1strcpy(stat, word);
-                break;
-            /* Obtains number of major faults the process has made */
-            case 12:
-                p1strcpy(flts, word);
-                compact_num(flts);
-                break;
-            /* Obtains amount of time in user mode (in clock ticks) */
-            case 14:
-                p1strcpy(usrtm, word);
-                ticks_to_sec(usrtm);
-                break;
-            /* Obtains amount of time in kernel mode (in clock ticks) */
-            case 15:
-                p1strcpy(systm, word);
-                ticks_to_sec(systm);
-                break;
-            /* Obtains the virtual memory size (in bytes) */
-            case 23:
-                p1strcpy(vmsz, word);
-                compact_size(vmsz);
-                break;
-            /* Obtains the resident set size (in bytes) */
-            case 24:
-                p1strcpy(rssz, word);
-                pages_to_bytes(rssz);
-                break;
-            /* All other info useless, ignore */
-            default:
-                break;
-        }
-        i++;
-    }
-    close(stat_fd);
-    stat_fd = -1;
+    p1itoa((int)rp->pid, pid_str);
+
+    /* The system read and write calls */
+    p1ltoa(io->syscr, syscr);
+    compact_num(syscr);
+    p1ltoa(io->syscw, syscw);
+    compact_num(syscw);
+
+    /* Status, major faults, user and kernel time, virtual and resident size */
+    stat[0] = st->state;
+    stat[1] = '\0';
+    p1ltoa(st->majflt, flts);
+    compact_num(flts);
+    p1ltoa(st->utime, usrtm);
+    ticks_to_sec(usrtm);
+    p1ltoa(st->stime, systm);
+    ticks_to_sec(systm);
+    p1ltoa(st->vsize, vmsz);
+    compact_size(vmsz);
+    p1ltoa(st->rss, rssz);
+    pages_to_bytes(rssz);
 
     /* Redisplay the header when needed */
     if (!iter)
-        p1putstr(output_fd, "PID      SysCR   SysCW   State  Flts    UsrTm   SysTm   VMSz    RSSz    CPU  Cmd\n");
+        p1wputstr(report_out, "PID      SysCR   SysCW   State  Flts    UsrTm   SysTm   VMSz    RSSz    CPU  Cmd\n");
     /* Keep track how many lines printed so far, before reprinting header */
     if (++(iter) >= LIMIT)
         iter = 0;
@@ -930,23 +2880,146 @@ static void print(Process *pr) {
     res_ptr = p1strpack(cpu, 5, ' ', res_ptr);
     res_ptr = p1strpack(cmd, 0, ' ', res_ptr);
 
-    /* Adjust process's time quantum based on IO amount */
-    adjust_quantum(pr, n_io);
-
     /* Prints out the process information */
-    p1putstr(output_fd, res);
-    p1putstr(output_fd, "\n");
-    return;
+    p1wputstr(report_out, res);
+    p1wputstr(report_out, "\n");
+}
+
+/*
+ * Prints the raw counters of the process, either as a CSV row under the columns
+ * of CSV_HEADER, or as one JSON object per line with the same names as keys.
+ */
+static void print_fields(Report *rp, ProcStat *st, ProcIO *io, char *cmd) {
+
+    static char *events[] = { "run", "stop", "block", "exit" };
+    char state[2];
+
+    state[0] = st->state;
+    state[1] = '\0';
+
+    put_field("time_ns", 1);
+    put_num((unsigned long)(rp->when - start_time));
+    put_field("pid", 0);
+    put_num((unsigned long)rp->pid);
+    put_field("event", 0);
+    put_quoted(events[rp->event]);
+    put_field("state", 0);
+    put_quoted(state);
+    put_field("syscr", 0);
+    put_num(io->syscr);
+    put_field("syscw", 0);
+    put_num(io->syscw);
+    put_field("rchar", 0);
+    put_num(io->rchar);
+    put_field("wchar", 0);
+    put_num(io->wchar);
+    put_field("read_bytes", 0);
+    put_num(io->read_bytes);
+    put_field("write_bytes", 0);
+    put_num(io->write_bytes);
+    put_field("majflt", 0);
+    put_num(st->majflt);
+    put_field("utime_ticks", 0);
+    put_num(st->utime);
+    put_field("stime_ticks", 0);
+    put_num(st->stime);
+    put_field("vsize_bytes", 0);
+    put_num(st->vsize);
+    put_field("rss_bytes", 0);
+    put_num(st->rss * sysconf(_SC_PAGESIZE));
+    put_field("cpu_pct", 0);
+    put_num((unsigned long)rp->cpu);
+    put_field("cpu_ns", 0);
+    put_num((unsigned long)rp->cputime);
+    put_field("cmd", 0);
+    put_quoted(cmd);
+    p1wputstr(report_out, (format == F_JSONL) ? "}\n" : "\n");
+}
+
+/*
+ * Writes the raw counters of the process as one Record (see record.h).
+ */
+static void print_binary(Report *rp, ProcStat *st, ProcIO *io, char *cmd) {
+
+    Record rec;
+    int i;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.time = rp->when - start_time;
+    rec.syscr = io->syscr;
+    rec.syscw = io->syscw;
+    rec.rchar = io->rchar;
+    rec.wchar = io->wchar;
+    rec.read_bytes = io->read_bytes;
+    rec.write_bytes = io->write_bytes;
+    rec.majflt = st->majflt;
+    rec.utime = st->utime;
+    rec.stime = st->stime;
+    rec.vsize = st->vsize;
+    rec.rss = (uint64_t)st->rss * sysconf(_SC_PAGESIZE);
+    rec.pid = (uint32_t)rp->pid;
+    rec.event = (uint32_t)rp->event;
+    rec.cpu = (uint32_t)rp->cpu;
+    rec.cpu_ns = rp->cputime;
+    rec.state = st->state;
+    for (i = 0; cmd[i] != '\0' && i < REC_CMDLEN - 1; i++)
+        rec.cmd[i] = cmd[i];
+
+    p1wwrite(report_out, &rec, sizeof(rec));
+}
+
+/*
+ * Writes what comes before the value of the named field: for JSON, the opening
+ * brace or a comma, then the quoted key; for CSV, a comma unless it is first.
+ */
+static void put_field(char *name, int first) {
+
+    if (format == F_JSONL) {
+        p1wputstr(report_out, first ? "{\"" : ",\"");
+        p1wputstr(report_out, name);
+        p1wputstr(report_out, "\":");
+    } else if (!first) {
+        p1wputstr(report_out, ",");
+    }
+}
+
+/*
+ * Writes the number in full, in decimal.
+ */
+static void put_num(unsigned long n) {
 
-close_files:
-    /* Close any open files and return */
-    if (cmd_fd != -1)
-        close(cmd_fd);
-    if (io_fd != -1)
-        close(io_fd);
-    if (stat_fd != -1)
-        close(stat_fd);
-    return;
+    char buffer[32];
+
+    p1ltoa((long)n, buffer);
+    p1wputstr(report_out, buffer);
+}
+
+/*
+ * Writes the string in double quotes. For CSV, quotes inside it are doubled;
+ * for JSON, quotes and backslashes are escaped, as are control characters.
+ */
+static void put_quoted(char *s) {
+
+    static char hex[] = "0123456789abcdef";
+    char esc[8];
+
+    p1wputstr(report_out, "\"");
+    for (; *s != '\0'; s++) {
+        if (*s == '"') {
+            p1wputstr(report_out, (format == F_JSONL) ? "\\\"" : "\"\"");
+        } else if (format == F_JSONL && *s == '\\') {
+            p1wputstr(report_out, "\\\\");
+        } else if (format == F_JSONL && (unsigned char)*s < 0x20) {
+            p1strcpy(esc, "\\u00");
+            esc[4] = hex[(*s >> 4) & 0xF];
+            esc[5] = hex[*s & 0xF];
+            esc[6] = '\0';
+            p1wputstr(report_out, esc);
+        } else {
+            p1wwrite(report_out, s, 1);
+        }
+    }
+    p1wputstr(report_out, "\"");
 }
 
 /*
@@ -954,21 +3027,68 @@ close_files:
  */
 static void free_mem(void) {
 
+    int i;
+
+    stop_reporter();
+    stop_serving();
+    stop_capture();
     if (output_fd != STDOUT_FILENO)
         close(output_fd);
+    for (i = 0; i < nlanes; i++) {
+        if (lanes[i].timer_fd != -1)
+            close(lanes[i].timer_fd);
+        if (lanes[i].queue != NULL)
+            (*policy->destroy)(lanes[i].queue, (void *)free_pr);
+        free_pr(lanes[i].running);
+    }
+    free(lanes);
+    if (block_timer_fd != -1)
+        close(block_timer_fd);
+    if (blocked != NULL)
+        cl_destroy(blocked, (void *)free_pr);
+    if (signal_fd != -1)
+        close(signal_fd);
+    if (epoll_fd != -1)
+        close(epoll_fd);
+    if (pid_map != NULL)
+        pm_destroy(pid_map, NULL);
+    if (samplers != NULL)
+        pm_destroy(samplers, (void *)sm_close);
+    tr_destroy(trace);
+    if (trace_fd != -1)
+        close(trace_fd);
+    if (missed_list != NULL)
+        cl_destroy(missed_list, free);
     if (pr_list != NULL)
         cl_destroy(pr_list, (void *)free_pr);
+    if (held != NULL)
+        cl_destroy(held, (void *)free_pr);
+    if (deferred != NULL)
+        cl_destroy(deferred, (void *)free_pr);
+    dg_destroy(dag);
+    if (workload != NULL) {
+        p1rclose(workload);
+        if (workload_fd != STDIN_FILENO)
+            close(workload_fd);
+    }
 }
 
 /*
- * Prints out specified error message and exits program.
+ * Prints out specified error message and exits program with 1. Jobs that were
+ * forked and have not exited are killed and reaped first, rather than left
+ * stopped or frozen.
  */
 static void print_error(char *msg) {
 
     p1strcat(msg, "\n");
     p1putstr(STDOUT_FILENO, msg);
+    if (pid_map != NULL) {
+        pm_apply(pid_map, (void *)kill_job);
+        while (wait4(-1, NULL, 0, NULL) != -1 || errno == EINTR)
+            ;
+    }
     /* Also must free all resources */
     free_mem();
-    _exit(0);
+    _exit(1);
 }
 